@@ -8,3 +8,14 @@ if(USE_CLANG)
   SET(CMAKE_OBJDUMP       "llvm-objdump")
   SET(CMAKE_RANLIB        "llvm-ranlib")
 endif(USE_CLANG)
+
+# widths of the node/edge ids and of the distances in bits, 32 or 64.
+# 32 bit ids are enough for grids with up to a few hundred million nodes
+set(SHIPROUTER_INDEX_BITS 32 CACHE STRING "width of the node and edge ids in bits (32 or 64)")
+set(SHIPROUTER_WEIGHT_BITS 32 CACHE STRING "width of the distances in bits (32 or 64)")
+
+foreach(bits_option SHIPROUTER_INDEX_BITS SHIPROUTER_WEIGHT_BITS)
+  if(NOT ${bits_option} MATCHES "^(32|64)$")
+    message(FATAL_ERROR "${bits_option} has to be 32 or 64, got ${${bits_option}}")
+  endif()
+endforeach()
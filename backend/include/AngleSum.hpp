@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Vector3D.hpp>
+#include <cstddef>
+
+// sum of the signed angles between the vectors from the points of a closed
+// polygon to p, as seen from p. the points are given as structure of arrays
+// of unit vectors. uses AVX-512 or AVX2 if the cpu supports it
+auto angleSum(const double* x,
+              const double* y,
+              const double* z,
+              std::size_t size,
+              const Vector3D& p) noexcept
+    -> double;
@@ -15,6 +15,14 @@ public:
     auto addCoastline(std::vector<std::uint64_t> refs) noexcept
         -> void;
 
+    // sorted ids of all nodes referenced by any coastline, without duplicates
+    auto getReferencedNodes() const noexcept
+        -> std::vector<std::uint64_t>;
+
+    // moves all coastlines of other into this lookup
+    auto merge(CoastlineLookup&& other) noexcept
+        -> void;
+
 private:
     friend auto calculatePolygons(CoastlineLookup&& coastline_lookup,
                                   NodeLookup&& node_lookup) noexcept
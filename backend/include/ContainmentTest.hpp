@@ -0,0 +1,31 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+// how a polygon decides if a point is inside of it
+enum class ContainmentTest {
+    // polygons with many points use their edge index in the lat/lng
+    // plane, the others sum up the angles like ANGLE_SUM
+    EDGE_INDEX,
+    // sum of the angles between the vectors from all points of the polygon to the point
+    ANGLE_SUM,
+    // parity of the crossings of the polygon edges with the
+    // meridian arc from the point to the north pole
+    RAY_CASTING
+};
+
+inline auto parseContainmentTest(std::string_view name) noexcept
+    -> std::optional<ContainmentTest>
+{
+    if(name == "edge_index") {
+        return ContainmentTest::EDGE_INDEX;
+    }
+    if(name == "angle_sum") {
+        return ContainmentTest::ANGLE_SUM;
+    }
+    if(name == "ray_casting") {
+        return ContainmentTest::RAY_CASTING;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Utils.hpp>
+#include <vector>
+
+// adjacency lists of the nodes which are not contracted yet, used to contract
+// the nodes of a Graph one at a time. shortcuts are added and contracted
+// nodes are removed in place, the witness searches run on it
+class ContractionGraph
+{
+public:
+    // edge of the Graph from the owner of the list to `target`
+    struct Arc
+    {
+        NodeId target;
+        Distance dist;
+        EdgeId id;
+        EdgeId inverse_id;
+        // number of edges of the grid the arc stands for
+        std::uint32_t original_edges;
+    };
+
+    ContractionGraph(std::size_t number_of_nodes) noexcept;
+
+    auto size() const noexcept
+        -> std::size_t;
+
+    auto nodeContracted(NodeId node) const noexcept
+        -> bool;
+
+    auto arcsOf(NodeId node) const noexcept
+        -> const std::vector<Arc>&;
+
+    // adds the arc, an existing arc to the same target is replaced if the new one is shorter
+    auto addArc(NodeId source, Arc arc) noexcept
+        -> void;
+
+    // removes the node and all arcs to it
+    auto contract(NodeId node) noexcept
+        -> void;
+
+    template<class Callback>
+    auto forEachEdge(NodeId node, Callback&& callback) const noexcept
+        -> void;
+
+private:
+    std::vector<std::vector<Arc>> arcs_;
+    std::vector<bool> contracted_;
+};
+
+template<class Callback>
+auto ContractionGraph::forEachEdge(NodeId node, Callback&& callback) const noexcept
+    -> void
+{
+    for(const auto& arc : arcs_[node]) {
+        callback(arc.target, arc.dist);
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+// in which order the nodes of the graph are contracted
+enum class ContractionOrder {
+    // contract a quarter of an independent set of the remaining nodes per level,
+    // the nodes with the lowest edge difference first
+    INDEPENDENT_SET,
+    // contract one node at a time, always the one with the lowest priority
+    // of edge difference, deleted neighbours, original edges and depth
+    PRIORITY_QUEUE
+};
+
+inline auto parseContractionOrder(std::string_view name) noexcept
+    -> std::optional<ContractionOrder>
+{
+    if(name == "independent_set") {
+        return ContractionOrder::INDEPENDENT_SET;
+    }
+    if(name == "priority_queue") {
+        return ContractionOrder::PRIORITY_QUEUE;
+    }
+    return std::nullopt;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Graph.hpp>
+#include <ImplicitGridGraph.hpp>
 #include <SphericalGrid.hpp>
 #include <functional>
 #include <optional>
@@ -24,22 +25,22 @@ using DijkstraQueue = std::priority_queue<std::pair<NodeId, Distance>,
 
 
 
-class Dijkstra
+// plain dijkstra on any graph which provides `size` and `forEachEdge`.
+// instantiated for the Graph and the ImplicitGridGraph in Dijkstra.cpp
+template<class GraphType>
+class BasicDijkstra
 {
 public:
-    Dijkstra(const Graph& graph) noexcept;
-    Dijkstra() = delete;
-    Dijkstra(Dijkstra&&) = default;
-    Dijkstra(const Dijkstra&) = default;
-    auto operator=(const Dijkstra&) -> Dijkstra& = delete;
-    auto operator=(Dijkstra&&) -> Dijkstra& = delete;
+    BasicDijkstra(const GraphType& graph) noexcept;
+    BasicDijkstra() = delete;
+    BasicDijkstra(BasicDijkstra&&) = default;
+    BasicDijkstra(const BasicDijkstra&) = default;
+    auto operator=(const BasicDijkstra&) -> BasicDijkstra& = delete;
+    auto operator=(BasicDijkstra&&) -> BasicDijkstra& = delete;
 
     auto findRoute(NodeId source, NodeId target) noexcept
         -> DijkstraPath;
 
-
-    bool shortestPathContainsU(NodeId source, NodeId target, NodeId u, Distance dist) noexcept;
-
     auto findDistance(NodeId source, NodeId target) noexcept
         -> Distance;
 
@@ -69,14 +70,16 @@ private:
         -> void;
 
 private:
-    const Graph& graph_;
+    const GraphType& graph_;
     std::vector<Distance> distances_;
     std::vector<bool> settled_;
     std::vector<NodeId> touched_;
     std::vector<NodeId> previous_nodes_;
     DijkstraQueue pq_;
     std::optional<NodeId> last_source_;
-    std::optional<NodeId> last_u;
 
     uint q_pops_;
 };
+
+using Dijkstra = BasicDijkstra<Graph>;
+using ImplicitDijkstra = BasicDijkstra<ImplicitGridGraph>;
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <ContainmentTest.hpp>
+#include <ContractionOrder.hpp>
+#include <FilterMode.hpp>
+#include <WitnessSearch.hpp>
+#include <cstdlib>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 
@@ -32,10 +39,207 @@ public:
         return data_file_;
     }
 
+    auto getGridCacheFile() const
+        -> const std::optional<std::string>&
+    {
+        return grid_cache_file_;
+    }
+
+    auto setGridCacheFile(std::string grid_cache_file)
+        -> void
+    {
+        grid_cache_file_ = std::move(grid_cache_file);
+    }
+
+    auto getPolygonCacheFile() const
+        -> const std::optional<std::string>&
+    {
+        return polygon_cache_file_;
+    }
+
+    auto setPolygonCacheFile(std::string polygon_cache_file)
+        -> void
+    {
+        polygon_cache_file_ = std::move(polygon_cache_file);
+    }
+
+    auto getGraphSnapshotFile() const
+        -> const std::optional<std::string>&
+    {
+        return graph_snapshot_file_;
+    }
+
+    auto setGraphSnapshotFile(std::string graph_snapshot_file)
+        -> void
+    {
+        graph_snapshot_file_ = std::move(graph_snapshot_file);
+    }
+
+    auto prefetchSnapshot() const
+        -> bool
+    {
+        return prefetch_snapshot_;
+    }
+
+    auto setPrefetchSnapshot(bool prefetch)
+        -> void
+    {
+        prefetch_snapshot_ = prefetch;
+    }
+
+    auto preprocessOnly() const
+        -> bool
+    {
+        return preprocess_only_;
+    }
+
+    auto setPreprocessOnly(bool preprocess_only)
+        -> void
+    {
+        preprocess_only_ = preprocess_only;
+    }
+
+    auto twoPassExtraction() const
+        -> bool
+    {
+        return two_pass_extraction_;
+    }
+
+    auto setTwoPassExtraction(bool two_pass_extraction)
+        -> void
+    {
+        two_pass_extraction_ = two_pass_extraction;
+    }
+
+    auto getFilterMode() const
+        -> FilterMode
+    {
+        return filter_mode_;
+    }
+
+    auto setFilterMode(FilterMode filter_mode)
+        -> void
+    {
+        filter_mode_ = filter_mode;
+    }
+
+    auto filterBenchmark() const
+        -> bool
+    {
+        return filter_benchmark_;
+    }
+
+    auto setFilterBenchmark(bool filter_benchmark)
+        -> void
+    {
+        filter_benchmark_ = filter_benchmark;
+    }
+
+    auto incrementalUpdate() const
+        -> bool
+    {
+        return incremental_update_;
+    }
+
+    auto setIncrementalUpdate(bool incremental_update)
+        -> void
+    {
+        incremental_update_ = incremental_update;
+    }
+
+    auto polygonSimplification() const
+        -> bool
+    {
+        return polygon_simplification_;
+    }
+
+    auto setPolygonSimplification(bool polygon_simplification)
+        -> void
+    {
+        polygon_simplification_ = polygon_simplification;
+    }
+
+    auto getContainmentTest() const
+        -> ContainmentTest
+    {
+        return containment_test_;
+    }
+
+    auto setContainmentTest(ContainmentTest containment_test)
+        -> void
+    {
+        containment_test_ = containment_test;
+    }
+
+    auto containmentBenchmark() const
+        -> bool
+    {
+        return containment_benchmark_;
+    }
+
+    auto setContainmentBenchmark(bool containment_benchmark)
+        -> void
+    {
+        containment_benchmark_ = containment_benchmark;
+    }
+
+    auto getContractionOrder() const
+        -> ContractionOrder
+    {
+        return contraction_order_;
+    }
+
+    auto setContractionOrder(ContractionOrder contraction_order)
+        -> void
+    {
+        contraction_order_ = contraction_order;
+    }
+
+    auto getWitnessSearchLimits() const
+        -> WitnessSearchLimits
+    {
+        return witness_search_limits_;
+    }
+
+    auto setWitnessSearchLimits(WitnessSearchLimits witness_search_limits)
+        -> void
+    {
+        witness_search_limits_ = witness_search_limits;
+    }
+
+    auto implicitGraph() const
+        -> bool
+    {
+        return implicit_graph_;
+    }
+
+    auto setImplicitGraph(bool implicit_graph)
+        -> void
+    {
+        implicit_graph_ = implicit_graph;
+    }
+
 private:
     std::uint16_t port_;
     std::string data_file_;
     std::uint64_t number_of_sphere_nodes_;
+
+    // optional settings
+    std::optional<std::string> grid_cache_file_;
+    std::optional<std::string> polygon_cache_file_;
+    std::optional<std::string> graph_snapshot_file_;
+    bool prefetch_snapshot_ = false;
+    bool preprocess_only_ = false;
+    bool two_pass_extraction_ = false;
+    bool filter_benchmark_ = false;
+    FilterMode filter_mode_ = FilterMode::POLYGON_TREE;
+    bool incremental_update_ = false;
+    bool polygon_simplification_ = false;
+    bool containment_benchmark_ = false;
+    ContainmentTest containment_test_ = ContainmentTest::EDGE_INDEX;
+    ContractionOrder contraction_order_ = ContractionOrder::INDEPENDENT_SET;
+    WitnessSearchLimits witness_search_limits_;
+    bool implicit_graph_ = false;
 };
 
 
@@ -54,6 +258,72 @@ inline auto getEnv(std::string_view env_var) noexcept
     return str;
 }
 
+// flags are set if the variable is "1", "true" or "yes"
+inline auto getEnvFlag(std::string_view env_var) noexcept
+    -> bool
+{
+    const auto value = getEnv(env_var);
+    return value == "1" or value == "true" or value == "yes";
+}
+
+// numbers which can not be parsed are ignored
+inline auto getEnvNumber(std::string_view env_var) noexcept
+    -> std::optional<std::uint32_t>
+{
+    const auto value = getEnv(env_var);
+    if(!value) {
+        return std::nullopt;
+    }
+
+    try {
+        return static_cast<std::uint32_t>(std::stoul(value.value()));
+    } catch(...) {
+        return std::nullopt;
+    }
+}
+
+// reads the optional environment variables into the given environment
+inline auto loadOptionalEnv(Environment& env) noexcept
+    -> void
+{
+    if(auto grid_cache = getEnv("GRID_CACHE")) {
+        env.setGridCacheFile(std::move(grid_cache.value()));
+    }
+    if(auto polygon_cache = getEnv("POLYGON_CACHE")) {
+        env.setPolygonCacheFile(std::move(polygon_cache.value()));
+    }
+    if(auto graph_snapshot = getEnv("GRAPH_SNAPSHOT")) {
+        env.setGraphSnapshotFile(std::move(graph_snapshot.value()));
+    }
+    env.setPrefetchSnapshot(getEnvFlag("PREFETCH_SNAPSHOT"));
+    env.setPreprocessOnly(getEnvFlag("PREPROCESS_ONLY"));
+    env.setTwoPassExtraction(getEnvFlag("TWO_PASS_EXTRACTION"));
+    env.setFilterBenchmark(getEnvFlag("FILTER_BENCHMARK"));
+    if(auto filter_mode = getEnv("FILTER_MODE")) {
+        if(auto mode = parseFilterMode(filter_mode.value())) {
+            env.setFilterMode(mode.value());
+        }
+    }
+    env.setIncrementalUpdate(getEnvFlag("INCREMENTAL_UPDATE"));
+    env.setPolygonSimplification(getEnvFlag("POLYGON_SIMPLIFICATION"));
+    env.setContainmentBenchmark(getEnvFlag("CONTAINMENT_BENCHMARK"));
+    if(auto containment_test = getEnv("CONTAINMENT_TEST")) {
+        if(auto test = parseContainmentTest(containment_test.value())) {
+            env.setContainmentTest(test.value());
+        }
+    }
+    if(auto contraction_order = getEnv("CONTRACTION_ORDER")) {
+        if(auto order = parseContractionOrder(contraction_order.value())) {
+            env.setContractionOrder(order.value());
+        }
+    }
+    auto limits = env.getWitnessSearchLimits();
+    limits.max_hops = getEnvNumber("WITNESS_HOP_LIMIT").value_or(limits.max_hops);
+    limits.max_settled = getEnvNumber("WITNESS_SETTLE_LIMIT").value_or(limits.max_settled);
+    env.setWitnessSearchLimits(limits);
+    env.setImplicitGraph(getEnvFlag("IMPLICIT_GRAPH"));
+}
+
 inline auto loadEnv()
     -> std::optional<Environment>
 {
@@ -73,9 +343,11 @@ inline auto loadEnv()
         auto port = std::stoi(port_str);
         auto nodes_on_sphere = std::stoul(nodes_on_sphere_str);
 
-        return Environment{static_cast<std::uint16_t>(port),
-                           datafile_str,
-                           nodes_on_sphere};
+        auto env = Environment{static_cast<std::uint16_t>(port),
+                               datafile_str,
+                               nodes_on_sphere};
+        loadOptionalEnv(env);
+        return env;
     } catch(...) {
         return std::nullopt;
     }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+// how the polygons which could contain a node are found while filtering
+enum class FilterMode {
+    // test the bounding box of every polygon
+    LINEAR_SCAN,
+    // only visit the polygons whose bounding boxes contain the node
+    POLYGON_TREE,
+    // fill every row at once by the parity of the crossings of
+    // its latitude with the polygon edges left of each node
+    SCANLINE
+};
+
+inline auto parseFilterMode(std::string_view name) noexcept
+    -> std::optional<FilterMode>
+{
+    if(name == "linear_scan") {
+        return FilterMode::LINEAR_SCAN;
+    }
+    if(name == "polygon_tree") {
+        return FilterMode::POLYGON_TREE;
+    }
+    if(name == "scanline") {
+        return FilterMode::SCANLINE;
+    }
+    return std::nullopt;
+}
@@ -1,15 +1,36 @@
 #pragma once
 
+#include <ContractionOrder.hpp>
+#include <MappedFile.hpp>
 #include <Range.hpp>
 #include <SphericalGrid.hpp>
+#include <WitnessSearch.hpp>
 #include <nonstd/span.hpp>
-class Dijkstra;
+#include <optional>
+#include <string>
+#include <string_view>
 
+// the nodes of the graph are the water nodes of the grid, numbered along a hilbert
+// curve over their coordinates, such that nodes close to each other on the globe
+// have close ids. land nodes get no id, grid ids are translated at the boundary
 class Graph
 {
 public:
     Graph(SphericalGrid&& grid);
 
+    // the graph of a grid which was classified again after `previous` was built on a
+    // grid of the same size. nodes whose neighbours on the grid kept their land/water
+    // state copy their edges from the base edges of `previous`, which has to be
+    // contracted. only the nodes around the changed ones collect their edges again
+    Graph(SphericalGrid&& grid, const Graph& previous);
+
+    auto toGridId(NodeId node) const noexcept
+        -> std::size_t;
+
+    // NON_EXISTENT for land nodes and ids outside of the grid
+    auto fromGridId(std::size_t grid_id) const noexcept
+        -> NodeId;
+
     auto idToLat(NodeId id) const noexcept
         -> Latitude<Degree>;
 
@@ -25,66 +46,157 @@ public:
     auto isValidId(NodeId id) const noexcept
         -> bool;
 
+    // all edges of the node. only available until the graph is contracted,
+    // the contraction replaces them by the upward edges
     auto relaxEdgeIds(NodeId node) const noexcept
         -> nonstd::span<const EdgeId>;
 
+    // the edges of `relaxEdgeIds(node)` by value, in the same order.
+    // used by the searches, which only need the targets and distances
+    auto relaxEdges(NodeId node) const noexcept
+        -> nonstd::span<const HotEdge>;
+
+    // the edges of a contracted graph to nodes of a higher level. the graph is
+    // symmetric, so the backward search of the ch-dijkstra relaxes them as well
+    auto upwardEdges(NodeId node) const noexcept
+        -> nonstd::span<const HotEdge>;
+
+    // id of the edge at `upwardEdges(node)[i]`, needed to unwrap shortcuts
+    auto upwardEdgeId(NodeId node, std::size_t i) const noexcept
+        -> EdgeId;
+
+    // calls `callback(target, distance)` for every edge in `relaxEdges(node)`
+    template<class Callback>
+    auto forEachEdge(NodeId node, Callback&& callback) const noexcept
+        -> void
+    {
+        for(const auto& edge : relaxEdges(node)) {
+            callback(static_cast<NodeId>(edge.target), static_cast<Distance>(edge.dist));
+        }
+    }
+
     auto size() const noexcept
         -> std::size_t;
 
     auto snapToGridNode(Latitude<Degree> lat, Longitude<Degree> lng) const noexcept
         -> NodeId;
 
+    // NON_EXISTENT for land nodes
     auto gridToId(std::size_t m, std::size_t n) const noexcept
         -> NodeId;
 
-    auto isLandNode(NodeId node) const noexcept
-        -> bool;
-
     // generate `amount` many random source-target pairs
     std::vector<std::pair<NodeId, NodeId>> randomSTPairs(uint amount) const noexcept;
 
-    const Edge& getEdge(EdgeId edge_id) const noexcept;
-
     // all nodes that this edge (and its wrapped edges) represents, not including `target`
     Path unwrapEdge(EdgeId edge_id, NodeId target) const noexcept;
 
     Level getLevel(NodeId node) const noexcept;
 
-    void contract() noexcept;
+    void contract(ContractionOrder order = ContractionOrder::INDEPENDENT_SET,
+                  WitnessSearchLimits limits = {}) noexcept;
+    // contracts the graph in the order of the hierarchy of `previous`, new nodes first.
+    // every node is checked once instead of competing for its place in every step,
+    // the order, limits and snapshot key are the ones of `previous`
+    void contractInOrderOf(const Graph& previous) noexcept;
     bool nodeContracted(NodeId id) const noexcept;
 
+    // writes the contracted graph including the grid and the upward edges to `path`,
+    // keyed by the checksum of the data file, the requested number of nodes, the
+    // order the graph was contracted in and the limits of its witness searches
+    auto saveSnapshot(const std::string& path,
+                      std::uint64_t data_checksum,
+                      std::size_t number_of_nodes) const noexcept
+        -> bool;
+
+    // maps a snapshot written by `saveSnapshot` read-only into memory and restores
+    // the graph from it. all arrays are used in place, such that loading only reads
+    // the header and all processes which load the same snapshot share the data. if
+    // `prefetch` is set, the kernel is asked to read the whole file ahead instead of
+    // faulting in the pages one by one.
+    // returns std::nullopt if the snapshot does not exist or does not match. only the
+    // sizes of the arrays are checked, their content is trusted as `saveSnapshot` wrote it
+    static auto loadSnapshot(std::string_view path,
+                             std::uint64_t data_checksum,
+                             std::size_t number_of_nodes,
+                             ContractionOrder order,
+                             WitnessSearchLimits limits,
+                             bool prefetch) noexcept
+        -> std::optional<Graph>;
+
 private:
+    Graph() = default;
+    Graph(SphericalGrid&& grid, const Graph* previous);
+
     auto getSnapNodeCandidate(Latitude<Degree> lat,
                               Longitude<Degree> lng) const noexcept
         -> NodeId;
 
+    // grid ids of the neighbours on the grid, land nodes included
     auto getUpperGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-        -> std::vector<NodeId>;
+        -> std::vector<std::size_t>;
 
     auto getLowerGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-        -> std::vector<NodeId>;
+        -> std::vector<std::size_t>;
 
     auto getRowGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-        -> std::vector<NodeId>;
+        -> std::vector<std::size_t>;
 
     auto getGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-        -> std::vector<NodeId>;
+        -> std::vector<std::size_t>;
 
     // for contraction
 
-    // do one step of contraction
-    void contractionStep(Dijkstra& dijkstra) noexcept;
+    // witness search and shortcut buffer of one thread
+    struct ContractionWorker;
+    // contract independent sets of nodes until all nodes are contracted
+    void contractInSteps(WitnessSearchLimits limits, const std::vector<Level>* ranks) noexcept;
+    // do one step of contraction, the nodes are checked in parallel
+    // by one worker per thread. with `ranks` the independent set is taken
+    // by the ranks of the nodes and all of its nodes are contracted
+    void contractionStep(std::vector<ContractionWorker>& workers,
+                         const std::vector<Level>* ranks) noexcept;
+    // contract the nodes one at a time in the order of their priority
+    void contractByPriority(WitnessSearchLimits limits) noexcept;
     // construct an independent set of nodes that have not yet been contracted
     std::vector<NodeId> independentSet() const noexcept;
-    // update graph with new edges for the given source node
-    void insertEdges(std::vector<Edge> to_insert);
+    // the uncontracted nodes ranked lower than all of their uncontracted neighbours
+    std::vector<NodeId> independentSet(const std::vector<Level>& ranks) const noexcept;
+    // offsets and edges of the base graph of a contracted graph, by source node
+    auto baseEdges() const noexcept
+        -> std::pair<std::vector<std::size_t>, std::vector<HotEdge>>;
+    // sorts the edges from `first_new_edge` on, which were appended to edges_,
+    // into the adjacency arrays. linear in the number of edges and nodes,
+    // the arrays are built in the scratch buffers of the graph
+    void insertEdges(std::size_t first_new_edge) noexcept;
     // whether the node with the given ID is contracted
     // the "back-edge" for the given edge
     EdgeId inverseEdge(EdgeId edge) const noexcept;
+    // copies the targets and distances into hot_edges_ after sorted_edge_ids_ changed
+    auto rebuildHotEdges() noexcept
+        -> void;
+    // keeps only the upward edges of every node for the queries and
+    // releases the adjacency arrays used by the contraction
+    auto buildUpwardGraph() noexcept
+        -> void;
+    // copies the targets and distances into upward_edges_ after upward_edge_ids_ changed
+    auto rebuildUpwardEdges() noexcept
+        -> void;
 
 private:
-    std::vector<std::size_t> ns_;
-    std::vector<std::size_t> ms_;
+    // the part of an edge needed to unwrap it, in the layout of the snapshot.
+    // first_wrapped and second_wrapped are NON_EXISTENT if it is no shortcut
+    struct SnapshotEdge
+    {
+        NodeId source;
+        NodeId target;
+        EdgeId first_wrapped;
+        EdgeId second_wrapped;
+    };
+
+    // grid id of every node and node id of every grid node
+    std::vector<std::size_t> node_to_grid_;
+    std::vector<NodeId> grid_to_node_;
 
     std::vector<Edge> edges_;
     std::vector<size_t> offset_; // size: #nodes + 1
@@ -94,10 +206,43 @@ private:
     */
     std::vector<EdgeId> sorted_edge_ids_;
     /*
-    * auxiliary array 
+    * target and distance of the edges in the order of sorted_edge_ids_,
+    * the searches read only this array. size: #edges
+    */
+    std::vector<HotEdge> hot_edges_;
+    /*
+    * scratch buffers of insertEdges, swapped with offset_ and sorted_edge_ids_
+    * after every contraction step, such that their memory is used again
+    */
+    std::vector<std::size_t> new_offset_;
+    std::vector<EdgeId> new_sorted_edge_ids_;
+    std::vector<std::size_t> insert_position_;
+
+    /*
+    * the query graph of the contracted graph: the upward edges of every node,
+    * their ids are kept aside and only read to unwrap the shortcuts of a route.
+    * unwrap_edges_ replaces edges_ as the data to unwrap them.
+    * sizes: #nodes + 1, #upward edges, #edges
+    */
+    std::vector<std::size_t> upward_offset_;
+    std::vector<HotEdge> upward_edges_;
+    std::vector<EdgeId> upward_edge_ids_;
+    std::vector<SnapshotEdge> unwrap_edges_;
+
+    /*
+    * the arrays read by the queries. views of the vectors of this graph, or
+    * of the arrays of a loaded snapshot, which stay in its read-only mapping
     */
-    std::vector<std::pair<EdgeId, NodeId>> sorted_edge_ids_with_source_;
+    nonstd::span<const std::size_t> node_to_grid_view_;
+    nonstd::span<const NodeId> grid_to_node_view_;
+    nonstd::span<const Level> levels_view_;
+    nonstd::span<const std::size_t> upward_offset_view_;
+    nonstd::span<const HotEdge> upward_edges_view_;
+    nonstd::span<const EdgeId> upward_edge_ids_view_;
+    nonstd::span<const SnapshotEdge> unwrap_edges_view_;
+    std::optional<MappedFile> snapshot_file_;
 
+    // allocated by the first snap, loading a snapshot does not touch the whole grid
     mutable std::vector<bool> snap_settled_;
 
     // for ch-graph
@@ -107,6 +252,9 @@ private:
 
     Level current_level = 0;
     bool fully_contracted = false;
+    // part of the snapshot key, other orders or limits build a different hierarchy
+    ContractionOrder contraction_order_ = ContractionOrder::INDEPENDENT_SET;
+    WitnessSearchLimits witness_search_limits_;
 
-    const SphericalGrid grid_;
+    SphericalGrid grid_;
 };
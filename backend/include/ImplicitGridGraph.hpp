@@ -0,0 +1,73 @@
+#pragma once
+
+#include <LatLng.hpp>
+#include <SphericalGrid.hpp>
+#include <Utils.hpp>
+#include <Vector3D.hpp>
+#include <vector>
+
+// uncontracted graph over the water nodes of a grid which stores no edges.
+// the neighbours of a node and the lengths of the edges to them are generated
+// from the rows of the grid whenever the node is relaxed, only the row tables
+// and the land/water mask of the grid stay in memory
+class ImplicitGridGraph
+{
+public:
+    ImplicitGridGraph(SphericalGrid&& grid) noexcept;
+
+    auto size() const noexcept
+        -> std::size_t;
+
+    auto isLandNode(NodeId node) const noexcept
+        -> bool;
+
+    // the implicit graph is never contracted
+    auto nodeContracted(NodeId node) const noexcept
+        -> bool;
+
+    // calls `callback(target, distance)` for the same edges the Graph built from
+    // the grid has, a neighbour may be visited more than once
+    template<class Callback>
+    auto forEachEdge(NodeId node, Callback&& callback) const noexcept
+        -> void;
+
+    // generate `amount` many random source-target pairs, the same as Graph::randomSTPairs
+    std::vector<std::pair<NodeId, NodeId>> randomSTPairs(uint amount) const noexcept;
+
+private:
+    auto idToRow(NodeId node) const noexcept
+        -> std::size_t;
+
+    // position of the node in column `n` of row `m`. computed from the same
+    // coordinates as the grid's, such that the distances match the Graph's
+    auto nodeVector(std::size_t m, std::size_t n) const noexcept
+        -> Vector3D;
+
+    // the coordinates of the nodes are released, the rows are enough to compute them
+    SphericalGrid grid_;
+    std::vector<double> row_cos_lats_;
+    std::vector<double> row_sin_lats_;
+};
+
+template<class Callback>
+auto ImplicitGridGraph::forEachEdge(NodeId node, Callback&& callback) const noexcept
+    -> void
+{
+    const auto m = idToRow(node);
+    const auto first = grid_.first_index_of_[m];
+    const auto last = grid_.first_index_of_[m + 1];
+    const auto position = nodeVector(m, node - first);
+
+    grid_.forEachNeighbour(m, node - first, [&](auto neig) {
+        if(grid_.indexIsLand(neig)) {
+            return;
+        }
+
+        // neighbours lie in the row of the node or in one of the rows next to it
+        const auto neig_m = neig < first ? m - 1 : (neig < last ? m : m + 1);
+        const auto distance = position.distanceTo(
+            nodeVector(neig_m, neig - grid_.first_index_of_[neig_m]));
+
+        callback(static_cast<NodeId>(neig), static_cast<Distance>(distance));
+    });
+}
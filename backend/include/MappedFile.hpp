@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <nonstd/span.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    static auto open(std::string_view path) noexcept
+        -> std::optional<MappedFile>;
+
+    MappedFile() = delete;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile() noexcept;
+
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+    auto data() const noexcept
+        -> const std::uint8_t*;
+
+    auto size() const noexcept
+        -> std::size_t;
+
+    // asks the kernel to read the whole file into the page cache ahead of use
+    auto prefetch() const noexcept
+        -> void;
+
+    // 64 bit FNV-1a hash over the content of the file, used
+    // to key caches on the exact version of an input file
+    auto checksum() const noexcept
+        -> std::uint64_t;
+
+private:
+    MappedFile(const std::uint8_t* data, std::size_t size) noexcept;
+
+    const std::uint8_t* data_;
+    std::size_t size_;
+};
+
+// writes values and arrays in the layout expected by BinaryReader.
+// arrays are prefixed with their length and their data is padded to start
+// and end at a multiple of 8 bytes, such that they can be used directly
+// from a mapping of the written file, whatever values were written before
+class BinaryWriter
+{
+public:
+    BinaryWriter(const std::string& path);
+
+    auto good() const noexcept
+        -> bool;
+
+    // flushes and closes the file, returns false if any write failed
+    auto close()
+        -> bool;
+
+    template<class T>
+    auto write(const T& value)
+        -> void
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        written_ += sizeof(T);
+    }
+
+    template<class T>
+    auto writeArray(nonstd::span<const T> values)
+        -> void
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<std::uint64_t>(values.size()));
+        pad();
+        out_.write(reinterpret_cast<const char*>(values.data()),
+                   values.size() * sizeof(T));
+        written_ += values.size() * sizeof(T);
+        pad();
+    }
+
+    template<class T>
+    auto writeArray(const std::vector<T>& values)
+        -> void
+    {
+        writeArray(nonstd::span<const T>{values.data(), values.size()});
+    }
+
+private:
+    auto pad()
+        -> void;
+
+    std::ofstream out_;
+    std::size_t written_ = 0;
+};
+
+// sequential reader over a MappedFile. every read returns std::nullopt
+// instead of reading over the end of the mapping
+class BinaryReader
+{
+public:
+    BinaryReader(const MappedFile& file) noexcept;
+
+    template<class T>
+    auto read() noexcept
+        -> std::optional<T>
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if(position_ + sizeof(T) > file_.size()) {
+            return std::nullopt;
+        }
+
+        T value;
+        std::memcpy(&value, file_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+        return value;
+    }
+
+    template<class T>
+    auto readArray() noexcept
+        -> std::optional<nonstd::span<const T>>
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto size_opt = read<std::uint64_t>();
+        skipPadding();
+        if(!size_opt or size_opt.value() > (file_.size() - position_) / sizeof(T)) {
+            return std::nullopt;
+        }
+
+        // the mapping is page aligned, only a broken file misaligns the data
+        const auto* data = file_.data() + position_;
+        if(reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0) {
+            return std::nullopt;
+        }
+
+        const auto size = size_opt.value();
+        const auto* start = reinterpret_cast<const T*>(data);
+        position_ += size * sizeof(T);
+        skipPadding();
+
+        return nonstd::span<const T>{start, size};
+    }
+
+    template<class T>
+    auto readVector() noexcept
+        -> std::optional<std::vector<T>>
+    {
+        auto array = readArray<T>();
+        if(!array) {
+            return std::nullopt;
+        }
+        return std::vector<T>(std::begin(array.value()),
+                              std::end(array.value()));
+    }
+
+private:
+    auto skipPadding() noexcept
+        -> void;
+
+    const MappedFile& file_;
+    std::size_t position_ = 0;
+};
+
+// checksum of the file at the given path, std::nullopt if it can not be read
+auto fileChecksum(std::string_view path) noexcept
+    -> std::optional<std::uint64_t>;
+
+// writes the file at `path + ".tmp"` using `write_content` and moves it to `path`
+// afterwards, such that a crash while writing never leaves a broken file at `path`
+template<class Writer>
+auto writeFileAtomically(const std::string& path, Writer&& write_content) noexcept
+    -> bool
+{
+    const auto tmp_path = path + ".tmp";
+    try {
+        BinaryWriter writer{tmp_path};
+        if(!writer.good() or !write_content(writer) or !writer.close()) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    } catch(...) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
@@ -2,12 +2,14 @@
 
 #include <OSMNode.hpp>
 #include <Utils.hpp>
-#include <string_view>
-#include <unordered_map>
-#include <Polygon.hpp>
-
-class CoastlineLookup;
+#include <cstdint>
+#include <optional>
+#include <vector>
 
+// flat storage of osm nodes. nodes are appended while parsing and sorted
+// by their id in finalize, afterwards they can be found with a binary search.
+// coordinates are stored as fixed point numbers with the 100 nanodegree
+// resolution used by osm
 class NodeLookup
 {
 public:
@@ -16,11 +18,30 @@ public:
                  double lat) noexcept
         -> void;
 
+    // moves all nodes of other into this lookup
+    auto merge(NodeLookup&& other) noexcept
+        -> void;
+
+    // sorts the nodes by their id and removes duplicates,
+    // must be called before nodes can be found
+    auto finalize() noexcept
+        -> void;
+
+    auto findNode(std::uint64_t osmid) const noexcept
+        -> std::optional<OSMNode>;
+
 private:
-    friend auto calculatePolygons(CoastlineLookup&& coastline_lookup,
-                                  NodeLookup&& node_lookup) noexcept
-        -> std::vector<Polygon>;
+    struct Entry
+    {
+        std::uint64_t id;
+        std::int32_t lon;
+        std::int32_t lat;
+    };
+
+    // filled by addNode and merge, emptied by finalize
+    std::vector<Entry> unsorted_;
 
-  
-    std::unordered_map<std::uint64_t, OSMNode> nodes_;
+    std::vector<std::uint64_t> ids_;
+    std::vector<std::int32_t> lons_;
+    std::vector<std::int32_t> lats_;
 };
@@ -6,5 +6,8 @@
 #include <string_view>
 
 
-auto parsePBFFile(std::string_view path) noexcept
+// if only_coastline_nodes is set, the file is read twice: the first pass collects
+// the coastlines, the second pass keeps only the nodes referenced by them
+auto parsePBFFile(std::string_view path,
+                  bool only_coastline_nodes) noexcept
     -> std::pair<NodeLookup, CoastlineLookup>;
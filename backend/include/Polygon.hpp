@@ -1,18 +1,56 @@
 #pragma once
 
+#include <ContainmentTest.hpp>
 #include <OSMNode.hpp>
+#include <PolygonEdgeIndex.hpp>
 #include <Vector3D.hpp>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 class NodeLookup;
 class CoastlineLookup;
 
+struct BoundingBox
+{
+    Latitude<Degree> bottom;
+    Latitude<Degree> top;
+    Longitude<Degree> left;
+    Longitude<Degree> right;
+
+    auto contains(Latitude<Degree> lat, Longitude<Degree> lng) const noexcept
+        -> bool
+    {
+        return bottom <= lat and lat <= top and left <= lng and lng <= right;
+    }
+};
+
 class Polygon
 {
 public:
     Polygon(const std::vector<OSMNode>& nodes);
 
-    auto pointInPolygon(Latitude<Degree> lat, Longitude<Degree> lng, const Vector3D& p) const
+    // bounding boxes in the lat/lng plane. polygons wrapping around the
+    // antimeridian get one box on each side of it instead of a box
+    // covering all longitudes
+    auto getBoundingBoxes() const noexcept
+        -> const std::vector<BoundingBox>&;
+
+    // only EDGE_INDEX uses the edge index, the tests chosen
+    // explicitly check all edges of every polygon
+    auto pointInPolygon(Latitude<Degree> lat,
+                        Longitude<Degree> lng,
+                        const Vector3D& p,
+                        ContainmentTest test) const
+        -> bool;
+
+    // tests p against all edges of the polygon, without checking the
+    // bounding boxes or using the edge index. EDGE_INDEX sums up the angles
+    auto containsPoint(const Vector3D& p, ContainmentTest test) const
         -> bool;
 
     auto numberOfPoints() const
@@ -21,8 +59,32 @@ public:
     auto getLatAndLng() const
         -> std::vector<std::pair<double, double>>;
 
+    // hash over all points of the ring, used to find
+    // the rings which changed between two data files
+    auto hash() const noexcept
+        -> std::uint64_t;
+
 private:
-    std::vector<Vector3D> points_;
+    // used for polygons read from a polygon file, whose points
+    // are already converted to unit vectors and boxes are known
+    Polygon(std::vector<double>&& x,
+            std::vector<double>&& y,
+            std::vector<double>&& z,
+            BoundingBox extent,
+            std::vector<BoundingBox>&& bounding_boxes);
+
+    friend auto savePolygons(const std::string& path,
+                             std::uint64_t data_checksum,
+                             const std::vector<Polygon>& polygons) noexcept
+        -> bool;
+    friend auto loadPolygons(std::string_view path,
+                             std::uint64_t data_checksum) noexcept
+        -> std::optional<std::vector<Polygon>>;
+
+    // builds the edge index over the unit vectors if the polygon has many points
+    auto buildEdgeIndex() noexcept
+        -> void;
+
     std::vector<double> x_;
     std::vector<double> y_;
     std::vector<double> z_;
@@ -31,10 +93,76 @@ private:
     Latitude<Degree> bottom_;
     Longitude<Degree> right_;
 
+    std::vector<BoundingBox> bounding_boxes_;
+
+    // only built for polygons with many points, the other
+    // polygons are tested against all of their edges
+    std::optional<PolygonEdgeIndex> edge_index_;
+
     auto pointInRectangle(Latitude<Degree> lat, Longitude<Degree> lng) const -> bool;
 };
 
 
+// calls `callback(from, to)` for the parts of the edge between the two (lat, lng) points on
+// either side of the antimeridian. an edge across it is split at it. an edge starting or
+// ending on it has only one part, which also covers edges with both points on ±180°
+template<class Callback>
+auto forEachAntimeridianPart(std::pair<double, double> from,
+                             std::pair<double, double> to,
+                             Callback&& callback) noexcept
+    -> void
+{
+    const auto [lat_from, lng_from] = from;
+    const auto [lat_to, lng_to] = to;
+
+    if(std::abs(lng_to - lng_from) <= 180.0) {
+        callback(from, to);
+        return;
+    }
+
+    const auto border = lng_from < 0 ? -180.0 : 180.0;
+    if(lng_from == border) {
+        callback(std::pair{lat_from, -border}, to);
+        return;
+    }
+    if(lng_to == -border) {
+        callback(from, std::pair{lat_to, border});
+        return;
+    }
+
+    const auto unwrapped_lng_to = lng_from < 0 ? lng_to - 360.0 : lng_to + 360.0;
+    const auto lat_border = lat_from
+        + (border - lng_from) * (lat_to - lat_from) / (unwrapped_lng_to - lng_from);
+
+    callback(from, std::pair{lat_border, border});
+    callback(std::pair{lat_border, -border}, to);
+}
+
 auto calculatePolygons(CoastlineLookup&& coastline_lookup,
                        NodeLookup&& node_lookup) noexcept
     -> std::vector<Polygon>;
+
+// writes the assembled polygons to `path`, keyed by the checksum of the data file.
+// the polygons do not depend on the grid and are valid for every number of nodes
+auto savePolygons(const std::string& path,
+                  std::uint64_t data_checksum,
+                  const std::vector<Polygon>& polygons) noexcept
+    -> bool;
+
+// checksum of the data file the polygon file at `path` was written
+// for, std::nullopt if it does not exist or has another version
+auto polygonFileChecksum(std::string_view path) noexcept
+    -> std::optional<std::uint64_t>;
+
+// bounding boxes of the edges which are only part of one of the two polygon sets. rings
+// which changed only get boxes around the parts that differ, the nodes which change
+// between land and water are enclosed by these edges and lie inside of the boxes
+auto changedBoundingBoxes(const std::vector<Polygon>& old_polygons,
+                          const std::vector<Polygon>& new_polygons) noexcept
+    -> std::vector<BoundingBox>;
+
+// loads polygons written by `savePolygons`. returns std::nullopt if the file does
+// not exist, was written by another version or for another data file
+auto loadPolygons(std::string_view path,
+                  std::uint64_t data_checksum) noexcept
+    -> std::optional<std::vector<Polygon>>;
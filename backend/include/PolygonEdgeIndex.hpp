@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// grid of cells over the bounding box of a polygon in the lat/lng plane.
+// every cell stores the edges intersecting it and every row of cells stores
+// the sorted longitudes at which the polygon crosses the latitude of the row
+// center. the parity of a point is the number of crossings left of it on its
+// row center, corrected by the edges of its cell crossed when moving from
+// the row center to the point. a test therefore only touches the edges of a
+// single cell and a binary search over one row.
+// the index stores no points, it is built from and tested against the unit
+// vectors of the polygon, whose latitudes and longitudes it computes when needed
+class PolygonEdgeIndex
+{
+public:
+    // returns std::nullopt if the polygon can not be indexed in the lat/lng
+    // plane, because one of its edges wraps around the antimeridian
+    static auto build(const double* x,
+                      const double* y,
+                      const double* z,
+                      std::size_t size) noexcept
+        -> std::optional<PolygonEdgeIndex>;
+
+    // the points have to be the ones the index was built from
+    auto contains(double lat,
+                  double lng,
+                  const double* x,
+                  const double* y,
+                  const double* z,
+                  std::size_t size) const noexcept
+        -> bool;
+
+private:
+    PolygonEdgeIndex() = default;
+
+    auto cellOf(double lat, double lng) const noexcept
+        -> std::pair<std::size_t, std::size_t>;
+
+    double bottom_;
+    double left_;
+    double cell_height_;
+    double cell_width_;
+    std::size_t rows_;
+    std::size_t columns_;
+
+    // edge i connects the points i and (i + 1) % size, the edges of cell (row, column) are
+    // cell_edges_[cell_offsets_[row * columns_ + column] .. cell_offsets_[row * columns_ + column + 1]]
+    std::vector<std::uint32_t> cell_offsets_;
+    std::vector<std::uint32_t> cell_edges_;
+
+    // crossings of row r are row_crossings_[row_offsets_[r] .. row_offsets_[r + 1]]
+    std::vector<std::uint32_t> row_offsets_;
+    std::vector<double> row_crossings_;
+};
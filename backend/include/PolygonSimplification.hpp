@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Polygon.hpp>
+#include <vector>
+
+// douglas-peucker simplification of the polygon rings on the sphere. points
+// are removed as long as no removed point lies further than `tolerance` meters
+// away from the simplified ring. rings which would collapse to less than
+// a triangle are kept unchanged, such that no island disappears.
+// the simplification preserves the topology of the rings: a simplified edge
+// which crosses or touches another edge of its own or of any other ring is
+// split again at its douglas-peucker point, until no edges intersect. a ring
+// lying completely between a removed chain and the edge replacing it is not
+// detected, it is within `tolerance` of the coast
+auto simplifyPolygons(const std::vector<Polygon>& polygons, double tolerance) noexcept
+    -> std::vector<Polygon>;
+
+// total number of points of all polygons
+auto numberOfPoints(const std::vector<Polygon>& polygons) noexcept
+    -> std::size_t;
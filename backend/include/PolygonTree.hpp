@@ -0,0 +1,81 @@
+#pragma once
+
+#include <LatLng.hpp>
+#include <Polygon.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// bounding volume hierarchy over the bounding boxes of a set of polygons,
+// such that a point only visits the polygons whose boxes contain it
+class PolygonTree
+{
+public:
+    PolygonTree(const std::vector<Polygon>& polygons) noexcept;
+
+    // calls predicate with the index of every polygon whose bounding box
+    // contains the point, until the predicate returns true for one of them
+    template<class Predicate>
+    auto anyOf(Latitude<Degree> lat,
+               Longitude<Degree> lng,
+               Predicate&& predicate) const noexcept
+        -> bool
+    {
+        if(nodes_.empty()) {
+            return false;
+        }
+
+        // every visited inner node replaces itself with its two children,
+        // the stack never grows beyond the depth of the tree plus one
+        std::array<std::uint32_t, MAX_DEPTH + 1> stack;
+        std::size_t stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while(stack_size > 0) {
+            const auto& node = nodes_[stack[--stack_size]];
+            if(!node.box.contains(lat, lng)) {
+                continue;
+            }
+
+            if(node.count == 0) {
+                stack[stack_size++] = node.first;
+                stack[stack_size++] = node.first + 1;
+                continue;
+            }
+
+            for(auto i = node.first; i < node.first + node.count; i++) {
+                if(entries_[i].box.contains(lat, lng)
+                   and predicate(entries_[i].polygon)) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+private:
+    // inner nodes have a count of 0 and their children at first and first + 1,
+    // leaves contain the entries [first, first + count)
+    struct Node
+    {
+        BoundingBox box;
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    struct Entry
+    {
+        BoundingBox box;
+        std::size_t polygon;
+    };
+
+    constexpr static std::size_t LEAF_SIZE = 4;
+    constexpr static std::size_t MAX_DEPTH = 62;
+
+    auto build(std::size_t node, std::size_t begin, std::size_t end, std::size_t depth) noexcept
+        -> void;
+
+    std::vector<Node> nodes_;
+    std::vector<Entry> entries_;
+};
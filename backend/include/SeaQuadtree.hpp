@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ContainmentTest.hpp>
+#include <LatLng.hpp>
+#include <Polygon.hpp>
+#include <PolygonTree.hpp>
+#include <cstdint>
+#include <vector>
+
+// quadtree over the lat/lng plane, generated from the coastline polygons.
+// cells no coastline passes through are completely water or completely land,
+// only points in the remaining mixed cells need to be tested against the polygons
+class SeaQuadtree
+{
+public:
+    enum class Cell : std::uint8_t {
+        WATER,
+        LAND,
+        MIXED
+    };
+
+    // the cells of the deepest level are 180 / 2^max_depth degrees high
+    // and twice as wide, max_depth is limited to MAX_DEPTH
+    SeaQuadtree(const std::vector<Polygon>& polygons,
+                const PolygonTree& tree,
+                ContainmentTest test,
+                std::size_t max_depth) noexcept;
+
+    auto classify(Latitude<Degree> lat, Longitude<Degree> lng) const noexcept
+        -> Cell;
+
+    constexpr static std::size_t MAX_DEPTH = 16;
+
+private:
+    // inner nodes point to their four children at children, ..., children + 3,
+    // ordered by the next bit of the row and then of the column. leaves have 0
+    struct Node
+    {
+        std::uint32_t children;
+        Cell cell;
+    };
+
+    // leaf which is classified by testing the point at its center
+    struct Unclassified
+    {
+        std::size_t node;
+        std::size_t depth;
+        std::uint32_t row;
+        std::uint32_t column;
+    };
+
+    // keys are the interleaved rows and columns of the mixed cells
+    // of the deepest level, which lie inside of the given cell
+    auto build(std::size_t node,
+               std::size_t depth,
+               std::uint32_t row,
+               std::uint32_t column,
+               const std::uint32_t* keys_begin,
+               const std::uint32_t* keys_end,
+               std::vector<Unclassified>& unclassified) noexcept
+        -> void;
+
+    auto cellCenter(std::size_t depth, std::uint32_t row, std::uint32_t column) const noexcept
+        -> std::pair<Latitude<Degree>, Longitude<Degree>>;
+
+    std::size_t max_depth_;
+    std::vector<Node> nodes_;
+};
@@ -21,7 +21,8 @@ private:
     auto snapNode(Latitude<Degree> lat, Longitude<Degree> lng) const
         -> nlohmann::json;
 
-    auto getRoute(NodeId source, NodeId target)
+    // source and target are grid ids, as returned by the snapping
+    auto getRoute(std::size_t source, std::size_t target)
         -> std::optional<nlohmann::json>;
 
     auto setUpGETRoutes()
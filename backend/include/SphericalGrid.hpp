@@ -1,25 +1,30 @@
 #pragma once
 
+#include <ContainmentTest.hpp>
+#include <FilterMode.hpp>
 #include <LatLng.hpp>
+#include <MappedFile.hpp>
 #include <Polygon.hpp>
 #include <Utils.hpp>
 #include <cmath>
+#include <nonstd/span.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
+class BinaryReader;
+class BinaryWriter;
+
 class SphericalGrid
 {
 public:
     SphericalGrid(std::size_t number_of_nodes) noexcept;
 
     auto getLats() const noexcept
-        -> const std::vector<Latitude<Degree>>&;
+        -> nonstd::span<const Latitude<Degree>>;
     auto getLngs() const noexcept
-        -> const std::vector<Longitude<Degree>>&;
-
-    auto getLats() noexcept
-        -> std::vector<Latitude<Degree>>&;
-    auto getLngs() noexcept
-        -> std::vector<Longitude<Degree>>&;
+        -> nonstd::span<const Longitude<Degree>>;
 
     auto sphericalToGrid(Latitude<Radian> theta, Longitude<Radian> phi) const noexcept
         -> std::pair<std::size_t, std::size_t>;
@@ -39,6 +44,12 @@ public:
     auto getNeighbours(size_t m, size_t n) const noexcept
         -> std::vector<size_t>;
 
+    // calls `callback(id)` for the same neighbours as the functions above, in the
+    // same order and including land nodes and duplicates, without allocating
+    template<class Callback>
+    auto forEachNeighbour(size_t m, size_t n, Callback&& callback) const noexcept
+        -> void;
+
     auto snapToNode(Latitude<Degree> lat, Longitude<Degree> lng) const
         -> size_t;
 
@@ -67,24 +78,136 @@ public:
     auto indexIsLand(std::size_t idx) const noexcept
         -> bool;
 
-    auto filter(const std::vector<Polygon>& polygons) noexcept
+    auto filter(const std::vector<Polygon>& polygons,
+                FilterMode mode,
+                ContainmentTest test) noexcept
         -> void;
 
+    // classifies only the nodes inside of the given bounding boxes again, used
+    // to update a grid after some polygons changed. SCANLINE fills the whole rows
+    // through the boxes again. returns the number of nodes which changed
+    // between land and water
+    auto refilter(const std::vector<Polygon>& polygons,
+                  const std::vector<BoundingBox>& boxes,
+                  FilterMode mode,
+                  ContainmentTest test) noexcept
+        -> std::size_t;
+
     auto size() const noexcept
         -> std::size_t;
 
+    // average distance between neighbouring nodes in meters
+    auto nodeSpacing() const noexcept
+        -> double;
+
+    // writes the grid layout and the land/water mask to `path`, keyed by the checksum
+    // of the data file the mask was computed from and the requested number of nodes
+    auto save(const std::string& path,
+              std::uint64_t data_checksum,
+              std::size_t number_of_nodes) const noexcept
+        -> bool;
+
+    // loads a grid written by `save`, the coordinates and the mask stay in the mapping of
+    // the file. returns std::nullopt if the file does not exist, was written by another
+    // version or for another data file or number of nodes
+    static auto load(std::string_view path,
+                     std::uint64_t data_checksum,
+                     std::size_t number_of_nodes) noexcept
+        -> std::optional<SphericalGrid>;
+
+    // write/read only the grid layout and mask, used to embed the grid into other
+    // files like the graph snapshot. `read` uses the coordinates and the mask in
+    // place, the mapping of the reader has to outlive the grid
+    auto write(BinaryWriter& writer) const noexcept
+        -> void;
+    static auto read(BinaryReader& reader) noexcept
+        -> std::optional<SphericalGrid>;
+
 private:
+    SphericalGrid() = default;
+
     friend class Graph;
+    friend class ImplicitGridGraph;
     double a_;
     size_t n_rows_;
     double d_phi_;
     std::vector<size_t> first_index_of_;
     std::vector<Latitude<Degree>> lats_;
     std::vector<Longitude<Degree>> lngs_;
-    std::vector<bool> is_water_;
+    // one bit per node, node i is bit i % 64 of word i / 64
+    std::vector<std::uint64_t> is_water_;
+
+    /*
+    * the coordinates and the mask read by everything else. views of the
+    * vectors above, or of the arrays of a file the grid was read from
+    */
+    nonstd::span<const Latitude<Degree>> lats_view_;
+    nonstd::span<const Longitude<Degree>> lngs_view_;
+    nonstd::span<const std::uint64_t> is_water_view_;
+    std::optional<MappedFile> file_;
+
+    // copies a mask which is still in a mapping into is_water_ before it is changed
+    auto ownWaterMask() noexcept
+        -> void;
+    auto setWater(std::size_t idx, bool water) noexcept
+        -> void;
+
+    // classifies the nodes of the rows marked in `rows`, the
+    // nodes of the other rows are returned as land
+    auto filterRows(const std::vector<Polygon>& polygons,
+                    const std::vector<std::uint8_t>& rows,
+                    ContainmentTest test) noexcept
+        -> std::vector<std::uint8_t>;
 
     auto nCols(size_t m) const -> std::size_t;
     auto nCols(double theta) const -> std::size_t;
     auto calcTheta(size_t m) const -> double;
     auto calcPhi(size_t m, size_t n) const -> double;
 };
+
+template<class Callback>
+auto SphericalGrid::forEachNeighbour(size_t m, size_t n, Callback&& callback) const noexcept
+    -> void
+{
+    // the number of columns of a row is the distance between the first indices
+    const auto columnsOf = [&](auto row) {
+        return first_index_of_[row + 1] - first_index_of_[row];
+    };
+    const auto n_cols_in_this = columnsOf(m);
+
+    // row neighbours
+    callback(gridToID(m, (n + n_cols_in_this - 1) % n_cols_in_this));
+    callback(gridToID(m, (n + 1) % n_cols_in_this));
+
+    // upper neighbours
+    if(m == n_rows_ - 1) {
+        for(size_t i = 0; i < n_cols_in_this; i++) {
+            if(i != n) {
+                callback(gridToID(m, i));
+            }
+        }
+    } else {
+        const auto m_idx_upper = (m + 1) % n_rows_;
+        const auto n_cols_in_upper = columnsOf(m_idx_upper);
+        const auto upper_row_ratio = static_cast<long double>(n_cols_in_upper) / n_cols_in_this;
+        for(int i = floor((static_cast<int>(n) - 1) * upper_row_ratio); i <= ceil((n + 1) * upper_row_ratio); i++) {
+            callback(gridToID(m_idx_upper, (i + n_cols_in_upper) % n_cols_in_upper));
+        }
+    }
+
+    // lower neighbours
+    if(m == 0) {
+        for(size_t i = 0; i < first_index_of_[1]; i++) {
+            if(i != n) {
+                callback(gridToID(0, i));
+            }
+        }
+    } else {
+        const auto m_idx_lower = (m + n_rows_ - 1) % n_rows_;
+        const auto n_cols_in_lower = columnsOf(m_idx_lower);
+        const auto lower_row_ratio = static_cast<long double>(n_cols_in_lower) / n_cols_in_this;
+        for(int i = floor((static_cast<int>(n) - 1) * lower_row_ratio); i <= ceil((n + 1) * lower_row_ratio); i++) {
+            callback(gridToID(m_idx_lower, (i + n_cols_in_lower) % n_cols_in_lower));
+        }
+    }
+}
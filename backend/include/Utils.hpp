@@ -1,7 +1,10 @@
 #pragma once
 
 #include <Constants.hpp>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <type_traits>
 
 template<class T>
 using Ref = std::reference_wrapper<T>;
@@ -29,10 +32,34 @@ constexpr auto concat(Head0&& head0, Head1&& head1, Tail&&... tail) noexcept
 }
 
 
-using Distance = std::uint64_t;
-using NodeId = std::uint64_t;
-using EdgeId = std::uint64_t;
-using Level = std::uint64_t;
+// widths of the ids and the distances in bits, selected through the cmake
+// options of the same name. node and edge ids share one width, such that
+// NON_EXISTENT marks a missing node as well as a missing edge
+#ifndef SHIPROUTER_INDEX_BITS
+#define SHIPROUTER_INDEX_BITS 32
+#endif
+
+#ifndef SHIPROUTER_WEIGHT_BITS
+#define SHIPROUTER_WEIGHT_BITS 32
+#endif
+
+static_assert(SHIPROUTER_INDEX_BITS == 32 or SHIPROUTER_INDEX_BITS == 64,
+              "SHIPROUTER_INDEX_BITS has to be 32 or 64");
+static_assert(SHIPROUTER_WEIGHT_BITS == 32 or SHIPROUTER_WEIGHT_BITS == 64,
+              "SHIPROUTER_WEIGHT_BITS has to be 32 or 64");
+
+template<std::size_t Bits>
+using UnsignedOfWidth = std::conditional_t<Bits == 32, std::uint32_t, std::uint64_t>;
+
+using Distance = UnsignedOfWidth<SHIPROUTER_WEIGHT_BITS>;
+using NodeId = UnsignedOfWidth<SHIPROUTER_INDEX_BITS>;
+using EdgeId = UnsignedOfWidth<SHIPROUTER_INDEX_BITS>;
+using Level = UnsignedOfWidth<SHIPROUTER_INDEX_BITS>;
+
+// distances are in meters. a route, and every shortcut on it, is shorter than a
+// few times around the earth, the sum of two distances must not wrap around either
+static_assert(std::numeric_limits<Distance>::max() / 2 > 10 * 2 * PI * EARTH_RADIUS_IN_METERS,
+              "Distance is too narrow to hold the length of a route in meters");
 using Path = std::vector<NodeId>;
 using DijkstraPath = std::optional<std::tuple<Path, Distance, uint>>;
 
@@ -51,5 +78,12 @@ struct Edge
     std::optional<std::pair<EdgeId, EdgeId>> wrapped_edges;
 };
 
+// the part of an edge the searches need, stored by value next to the other edges of its source
+struct HotEdge
+{
+    NodeId target;
+    Distance dist;
+};
+
 constexpr static inline auto UNREACHABLE = std::numeric_limits<Distance>::max();
 constexpr static inline auto NON_EXISTENT = std::numeric_limits<NodeId>::max();
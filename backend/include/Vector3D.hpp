@@ -107,6 +107,24 @@ public:
     }
 
 
+    constexpr auto getX() const noexcept
+        -> double
+    {
+        return x_;
+    }
+
+    constexpr auto getY() const noexcept
+        -> double
+    {
+        return y_;
+    }
+
+    constexpr auto getZ() const noexcept
+        -> double
+    {
+        return z_;
+    }
+
     auto toString() const noexcept
         -> std::string
     {
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Utils.hpp>
+#include <functional>
+#include <queue>
+#include <vector>
+
+class Graph;
+class ContractionGraph;
+
+// bounds of a single witness search, 0 disables a limit. a search which hits a
+// limit may miss a witness, which only costs an unnecessary shortcut
+struct WitnessSearchLimits
+{
+    // edges on the path from the source to a node
+    std::uint32_t max_hops = 16;
+    // nodes settled by the search
+    std::uint32_t max_settled = 1000;
+};
+
+// how often witness searches stopped at a limit before all their targets were settled
+struct WitnessSearchStatistics
+{
+    std::size_t searches = 0;
+    std::size_t hop_limit_hits = 0;
+    std::size_t settle_limit_hits = 0;
+
+    auto operator+=(const WitnessSearchStatistics& other) noexcept
+        -> WitnessSearchStatistics&
+    {
+        searches += other.searches;
+        hop_limit_hits += other.hop_limit_hits;
+        settle_limit_hits += other.settle_limit_hits;
+        return *this;
+    }
+};
+
+// one-to-many dijkstra from a neighbour of a contracted node to the other neighbours,
+// which does not pass the contracted node. works on any graph which provides
+// `size`, `forEachEdge` and `nodeContracted`, instantiated in WitnessSearch.cpp
+template<class GraphType>
+class BasicWitnessSearch
+{
+public:
+    BasicWitnessSearch(const GraphType& graph, WitnessSearchLimits limits) noexcept;
+
+    // searches from `source` around `avoided` until all `targets` are settled,
+    // the next node is further away than `max_dist` or a limit is hit
+    auto run(NodeId source,
+             NodeId avoided,
+             const std::vector<NodeId>& targets,
+             Distance max_dist) noexcept
+        -> void;
+
+    // length of the shortest path the last search found to the node, UNREACHABLE
+    // if it found none. longer than the shortest path if the search was stopped
+    auto distanceTo(NodeId node) const noexcept
+        -> Distance;
+
+    auto getStatistics() const noexcept
+        -> const WitnessSearchStatistics&;
+
+private:
+    auto reset() noexcept
+        -> void;
+
+private:
+    using Queue = std::priority_queue<std::pair<Distance, NodeId>,
+                                      std::vector<std::pair<Distance, NodeId>>,
+                                      std::greater<>>;
+
+    const GraphType& graph_;
+    WitnessSearchLimits limits_;
+    WitnessSearchStatistics statistics_;
+
+    std::vector<Distance> distances_;
+    std::vector<std::uint32_t> hops_;
+    std::vector<bool> settled_;
+    std::vector<bool> is_target_;
+    std::vector<NodeId> touched_;
+    std::vector<NodeId> targets_;
+    Queue pq_;
+};
+
+using WitnessSearch = BasicWitnessSearch<Graph>;
+using ContractionWitnessSearch = BasicWitnessSearch<ContractionGraph>;
@@ -0,0 +1,233 @@
+#include <AngleSum.hpp>
+#include <Vector3D.hpp>
+
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#define SHIPROUTER_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+using AngleSumKernel = double (*)(const double*,
+                                  const double*,
+                                  const double*,
+                                  std::size_t,
+                                  const Vector3D&) noexcept;
+
+// angle of the edge from point i to point j, the same computation
+// as Vector3D::angleBetween on the vectors from the points to p
+auto edgeAngle(const double* x,
+               const double* y,
+               const double* z,
+               std::size_t i,
+               std::size_t j,
+               const Vector3D& p) noexcept
+    -> double
+{
+    const auto first = p - Vector3D{x[i], y[i], z[i]};
+    const auto second = p - Vector3D{x[j], y[j], z[j]};
+    return first.angleBetween(second, p);
+}
+
+auto angleSumScalar(const double* x,
+                    const double* y,
+                    const double* z,
+                    std::size_t size,
+                    const Vector3D& p) noexcept
+    -> double
+{
+    double sum = 0.0;
+    for(std::size_t i = 0; i < size; i++) {
+        sum += edgeAngle(x, y, z, i, (i + 1) % size, p);
+    }
+    return sum;
+}
+
+#ifdef SHIPROUTER_X86_KERNELS
+
+// the constants of atan2_approximation1, which are partly float literals
+const auto ATAN_EPSILON = static_cast<double>(1e-10f);
+const auto ATAN_C1 = static_cast<double>(0.1963f);
+const auto ATAN_C2 = static_cast<double>(0.9817f);
+
+__attribute__((target("avx2"))) auto angleSumAvx2(const double* x,
+                                                  const double* y,
+                                                  const double* z,
+                                                  std::size_t size,
+                                                  const Vector3D& p) noexcept
+    -> double
+{
+    constexpr std::size_t WIDTH = 4;
+
+    const auto px = _mm256_set1_pd(p.getX());
+    const auto py = _mm256_set1_pd(p.getY());
+    const auto pz = _mm256_set1_pd(p.getZ());
+    const auto zero = _mm256_setzero_pd();
+    const auto sign_bit = _mm256_set1_pd(-0.0);
+    const auto epsilon = _mm256_set1_pd(ATAN_EPSILON);
+    const auto c1 = _mm256_set1_pd(ATAN_C1);
+    const auto c2 = _mm256_set1_pd(ATAN_C2);
+    const auto quarter_pi = _mm256_set1_pd(M_PI / 4.0);
+    const auto three_quarter_pi = _mm256_set1_pd(3.0 * M_PI / 4.0);
+
+    auto sums = _mm256_setzero_pd();
+
+    // edges from i to i + 1, the closing edge is added below
+    std::size_t i = 0;
+    for(; i + WIDTH < size; i += WIDTH) {
+        const auto ax = _mm256_sub_pd(px, _mm256_loadu_pd(x + i));
+        const auto ay = _mm256_sub_pd(py, _mm256_loadu_pd(y + i));
+        const auto az = _mm256_sub_pd(pz, _mm256_loadu_pd(z + i));
+        const auto bx = _mm256_sub_pd(px, _mm256_loadu_pd(x + i + 1));
+        const auto by = _mm256_sub_pd(py, _mm256_loadu_pd(y + i + 1));
+        const auto bz = _mm256_sub_pd(pz, _mm256_loadu_pd(z + i + 1));
+
+        const auto cx = _mm256_sub_pd(_mm256_mul_pd(ay, bz), _mm256_mul_pd(az, by));
+        const auto cy = _mm256_sub_pd(_mm256_mul_pd(az, bx), _mm256_mul_pd(ax, bz));
+        const auto cz = _mm256_sub_pd(_mm256_mul_pd(ax, by), _mm256_mul_pd(ay, bx));
+
+        const auto length = _mm256_sqrt_pd(
+            _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(cx, cx), _mm256_mul_pd(cy, cy)),
+                          _mm256_mul_pd(cz, cz)));
+        const auto orientation = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(cx, px), _mm256_mul_pd(cy, py)),
+                                               _mm256_mul_pd(cz, pz));
+        const auto negative = _mm256_cmp_pd(orientation, zero, _CMP_LT_OQ);
+
+        // atan2_approximation1(sin, cos)
+        const auto sin = _mm256_blendv_pd(length, _mm256_sub_pd(zero, length), negative);
+        const auto cos = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ax, bx), _mm256_mul_pd(ay, by)),
+                                       _mm256_mul_pd(az, bz));
+
+        const auto abs_sin = _mm256_add_pd(_mm256_andnot_pd(sign_bit, sin), epsilon);
+        const auto cos_negative = _mm256_cmp_pd(cos, zero, _CMP_LT_OQ);
+        const auto r = _mm256_div_pd(
+            _mm256_blendv_pd(_mm256_sub_pd(cos, abs_sin), _mm256_add_pd(cos, abs_sin), cos_negative),
+            _mm256_blendv_pd(_mm256_add_pd(cos, abs_sin), _mm256_sub_pd(abs_sin, cos), cos_negative));
+
+        auto angle = _mm256_blendv_pd(quarter_pi, three_quarter_pi, cos_negative);
+        angle = _mm256_add_pd(angle,
+                              _mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(_mm256_mul_pd(c1, r), r), c2), r));
+        angle = _mm256_blendv_pd(angle,
+                                 _mm256_sub_pd(zero, angle),
+                                 _mm256_cmp_pd(sin, zero, _CMP_LT_OQ));
+
+        sums = _mm256_add_pd(sums, angle);
+    }
+
+    alignas(32) double lanes[WIDTH];
+    _mm256_store_pd(lanes, sums);
+    auto sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    for(; i < size; i++) {
+        sum += edgeAngle(x, y, z, i, (i + 1) % size, p);
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f"))) auto angleSumAvx512(const double* x,
+                                                       const double* y,
+                                                       const double* z,
+                                                       std::size_t size,
+                                                       const Vector3D& p) noexcept
+    -> double
+{
+    constexpr std::size_t WIDTH = 8;
+
+    const auto px = _mm512_set1_pd(p.getX());
+    const auto py = _mm512_set1_pd(p.getY());
+    const auto pz = _mm512_set1_pd(p.getZ());
+    const auto zero = _mm512_setzero_pd();
+    const auto epsilon = _mm512_set1_pd(ATAN_EPSILON);
+    const auto c1 = _mm512_set1_pd(ATAN_C1);
+    const auto c2 = _mm512_set1_pd(ATAN_C2);
+    const auto quarter_pi = _mm512_set1_pd(M_PI / 4.0);
+    const auto three_quarter_pi = _mm512_set1_pd(3.0 * M_PI / 4.0);
+
+    auto sums = _mm512_setzero_pd();
+
+    // edges from i to i + 1, the closing edge is added below
+    std::size_t i = 0;
+    for(; i + WIDTH < size; i += WIDTH) {
+        const auto ax = _mm512_sub_pd(px, _mm512_loadu_pd(x + i));
+        const auto ay = _mm512_sub_pd(py, _mm512_loadu_pd(y + i));
+        const auto az = _mm512_sub_pd(pz, _mm512_loadu_pd(z + i));
+        const auto bx = _mm512_sub_pd(px, _mm512_loadu_pd(x + i + 1));
+        const auto by = _mm512_sub_pd(py, _mm512_loadu_pd(y + i + 1));
+        const auto bz = _mm512_sub_pd(pz, _mm512_loadu_pd(z + i + 1));
+
+        const auto cx = _mm512_sub_pd(_mm512_mul_pd(ay, bz), _mm512_mul_pd(az, by));
+        const auto cy = _mm512_sub_pd(_mm512_mul_pd(az, bx), _mm512_mul_pd(ax, bz));
+        const auto cz = _mm512_sub_pd(_mm512_mul_pd(ax, by), _mm512_mul_pd(ay, bx));
+
+        const auto length = _mm512_sqrt_pd(
+            _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(cx, cx), _mm512_mul_pd(cy, cy)),
+                          _mm512_mul_pd(cz, cz)));
+        const auto orientation = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(cx, px), _mm512_mul_pd(cy, py)),
+                                               _mm512_mul_pd(cz, pz));
+        const auto negative = _mm512_cmp_pd_mask(orientation, zero, _CMP_LT_OQ);
+
+        // atan2_approximation1(sin, cos)
+        const auto sin = _mm512_mask_sub_pd(length, negative, zero, length);
+        const auto cos = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(ax, bx), _mm512_mul_pd(ay, by)),
+                                       _mm512_mul_pd(az, bz));
+
+        const auto abs_sin = _mm512_add_pd(_mm512_max_pd(sin, _mm512_sub_pd(zero, sin)), epsilon);
+        const auto cos_negative = _mm512_cmp_pd_mask(cos, zero, _CMP_LT_OQ);
+        const auto r = _mm512_div_pd(
+            _mm512_mask_blend_pd(cos_negative, _mm512_sub_pd(cos, abs_sin), _mm512_add_pd(cos, abs_sin)),
+            _mm512_mask_blend_pd(cos_negative, _mm512_add_pd(cos, abs_sin), _mm512_sub_pd(abs_sin, cos)));
+
+        auto angle = _mm512_mask_blend_pd(cos_negative, quarter_pi, three_quarter_pi);
+        angle = _mm512_add_pd(angle,
+                              _mm512_mul_pd(_mm512_sub_pd(_mm512_mul_pd(_mm512_mul_pd(c1, r), r), c2), r));
+        angle = _mm512_mask_sub_pd(angle,
+                                   _mm512_cmp_pd_mask(sin, zero, _CMP_LT_OQ),
+                                   zero,
+                                   angle);
+
+        sums = _mm512_add_pd(sums, angle);
+    }
+
+    alignas(64) double lanes[WIDTH];
+    _mm512_store_pd(lanes, sums);
+    auto sum = 0.0;
+    for(auto lane : lanes) {
+        sum += lane;
+    }
+
+    for(; i < size; i++) {
+        sum += edgeAngle(x, y, z, i, (i + 1) % size, p);
+    }
+    return sum;
+}
+
+#endif
+
+auto selectKernel() noexcept
+    -> AngleSumKernel
+{
+#ifdef SHIPROUTER_X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) {
+        return angleSumAvx512;
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        return angleSumAvx2;
+    }
+#endif
+    return angleSumScalar;
+}
+
+} // namespace
+
+auto angleSum(const double* x,
+              const double* y,
+              const double* z,
+              std::size_t size,
+              const Vector3D& p) noexcept
+    -> double
+{
+    static const auto kernel = selectKernel();
+    return kernel(x, y, z, size, p);
+}
@@ -44,15 +44,12 @@ DijkstraPath CHDijkstra::findRoute(NodeId source, NodeId target) noexcept
             continue;
         }
 
-        auto edge_ids = graph_.relaxEdgeIds(cur_node); // we can use this for both searches
+        // only the upward edges are relaxed. the graph is symmetric, the edges from
+        // higher nodes into this one are the reverse of them, so we can use this for both searches
+        const auto edges = graph_.upwardEdges(cur_node);
         // check if we can stall the node
         bool can_stall = false;
-        for(auto edge_id : edge_ids) {
-            const auto& edge = graph_.getEdge(edge_id);
-            if(graph_.getLevel(edge.source) >= graph_.getLevel(edge.target)) {
-                break;
-            }
-
+        for(const auto& edge : edges) {
             const auto saved_dist_to_target = (*dists[direction])[edge.target];
             if(saved_dist_to_target != UNREACHABLE and saved_dist_to_target + edge.dist < q_node.dist) {
                 can_stall = true;
@@ -63,16 +60,13 @@ DijkstraPath CHDijkstra::findRoute(NodeId source, NodeId target) noexcept
             continue;
         }
 
-        for(auto edge_id : edge_ids) {
-            const auto& edge = graph_.getEdge(edge_id);
+        for(std::size_t i = 0; i < edges.size(); i++) {
+            const auto& edge = edges[i];
             NodeId target = edge.target;
-            if(graph_.getLevel(edge.source) >= graph_.getLevel(target)) {
-                break;
-            }
             Distance dist_with_edge = q_node.dist + edge.dist;
             if(dist_with_edge < (*dists[direction])[target]) {
                 (*dists[direction])[target] = dist_with_edge;
-                (*previous_edges_[direction])[target] = edge_id;
+                (*previous_edges_[direction])[target] = graph_.upwardEdgeId(cur_node, i);
                 touched_.emplace_back(target);
                 q_.emplace(target, dist_with_edge, direction);
 
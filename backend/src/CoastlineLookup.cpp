@@ -1,6 +1,8 @@
 #include <Coastline.hpp>
 #include <CoastlineLookup.hpp>
 #include <Utils.hpp>
+#include <algorithm>
+#include <execution>
 #include <fmt/core.h>
 #include <string>
 #include <unordered_map>
@@ -11,3 +13,42 @@ auto CoastlineLookup::addCoastline(std::vector<std::uint64_t> refs) noexcept
 {
     coastlines_.try_emplace(refs.front(), std::move(refs));
 }
+
+auto CoastlineLookup::getReferencedNodes() const noexcept
+    -> std::vector<std::uint64_t>
+{
+    std::size_t number_of_refs = 0;
+    for(const auto& [_, coastline] : coastlines_) {
+        number_of_refs += coastline.getRefs().size();
+    }
+
+    std::vector<std::uint64_t> refs;
+    refs.reserve(number_of_refs);
+    for(const auto& [_, coastline] : coastlines_) {
+        const auto& coastline_refs = coastline.getRefs();
+        refs.insert(std::end(refs),
+                    std::begin(coastline_refs),
+                    std::end(coastline_refs));
+    }
+
+    std::sort(std::execution::par,
+              std::begin(refs),
+              std::end(refs));
+    refs.erase(std::unique(std::begin(refs), std::end(refs)),
+               std::end(refs));
+    refs.shrink_to_fit();
+
+    return refs;
+}
+
+auto CoastlineLookup::merge(CoastlineLookup&& other) noexcept
+    -> void
+{
+    if(coastlines_.empty()) {
+        coastlines_ = std::move(other.coastlines_);
+        return;
+    }
+
+    coastlines_.merge(other.coastlines_);
+    other.coastlines_.clear();
+}
@@ -0,0 +1,57 @@
+#include <ContractionGraph.hpp>
+#include <algorithm>
+
+ContractionGraph::ContractionGraph(std::size_t number_of_nodes) noexcept
+    : arcs_(number_of_nodes),
+      contracted_(number_of_nodes, false) {}
+
+auto ContractionGraph::size() const noexcept
+    -> std::size_t
+{
+    return arcs_.size();
+}
+
+auto ContractionGraph::nodeContracted(NodeId node) const noexcept
+    -> bool
+{
+    return contracted_[node];
+}
+
+auto ContractionGraph::arcsOf(NodeId node) const noexcept
+    -> const std::vector<Arc>&
+{
+    return arcs_[node];
+}
+
+auto ContractionGraph::addArc(NodeId source, Arc arc) noexcept
+    -> void
+{
+    auto& arcs = arcs_[source];
+    const auto existing = std::find_if(std::begin(arcs),
+                                       std::end(arcs),
+                                       [&](const auto& other) {
+                                           return other.target == arc.target;
+                                       });
+    if(existing == std::end(arcs)) {
+        arcs.emplace_back(arc);
+    } else if(arc.dist < existing->dist) {
+        *existing = arc;
+    }
+}
+
+auto ContractionGraph::contract(NodeId node) noexcept
+    -> void
+{
+    for(const auto& arc : arcs_[node]) {
+        auto& neighbour_arcs = arcs_[arc.target];
+        neighbour_arcs.erase(std::remove_if(std::begin(neighbour_arcs),
+                                            std::end(neighbour_arcs),
+                                            [&](const auto& other) {
+                                                return other.target == node;
+                                            }),
+                             std::end(neighbour_arcs));
+    }
+
+    arcs_[node] = {};
+    contracted_[node] = true;
+}
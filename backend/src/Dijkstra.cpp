@@ -1,5 +1,6 @@
 #include <Dijkstra.hpp>
 #include <Graph.hpp>
+#include <ImplicitGridGraph.hpp>
 #include <SphericalGrid.hpp>
 #include <functional>
 #include <numeric>
@@ -8,7 +9,8 @@
 #include <string_view>
 #include <vector>
 
-Dijkstra::Dijkstra(const Graph& graph) noexcept
+template<class GraphType>
+BasicDijkstra<GraphType>::BasicDijkstra(const GraphType& graph) noexcept
     : graph_(graph),
       distances_(graph_.size(), UNREACHABLE),
       settled_(graph_.size(), false),
@@ -16,7 +18,8 @@ Dijkstra::Dijkstra(const Graph& graph) noexcept
       pq_(DijkstraQueueComparer{}) {}
 
 
-auto Dijkstra::findRoute(NodeId source, NodeId target) noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::findRoute(NodeId source, NodeId target) noexcept
     -> DijkstraPath
 {
     if(source == last_source_
@@ -47,100 +50,45 @@ auto Dijkstra::findRoute(NodeId source, NodeId target) noexcept
         pq_.pop();
         q_pops_++;
 
-        const auto edge_ids = graph_.relaxEdgeIds(current_node);
-
-        for(auto edge_id : edge_ids) {
-            const auto& e = graph_.getEdge(edge_id);
-            auto neig_dist = getDistanceTo(e.target);
-            const auto new_dist = current_dist + e.dist;
+        graph_.forEachEdge(current_node, [&](auto target, auto dist) {
+            auto neig_dist = getDistanceTo(target);
+            const auto new_dist = current_dist + dist;
 
             if(UNREACHABLE != current_dist and neig_dist > new_dist) {
-                touched_.emplace_back(e.target);
-                setDistanceTo(e.target, new_dist);
-                pq_.emplace(e.target, new_dist);
-                previous_nodes_[e.target] = current_node;
+                touched_.emplace_back(target);
+                setDistanceTo(target, new_dist);
+                pq_.emplace(target, new_dist);
+                previous_nodes_[target] = current_node;
             }
-        }
+        });
     }
 
     return extractShortestPath(source, target);
 }
 
-bool Dijkstra::shortestPathContainsU(NodeId source, NodeId target, NodeId u, Distance dist) noexcept
-{
-    if(source == last_source_
-       and u == last_u
-       and isSettled(target)
-       and previous_nodes_[target] != NON_EXISTENT) {
-        return distances_[target] > dist;
-    }
-
-    if(source != last_source_ or last_u != u or previous_nodes_[target] == NON_EXISTENT) {
-        last_source_ = source;
-        last_u = u;
-        reset();
-        pq_.emplace(source, 0l);
-        setDistanceTo(source, 0);
-        touched_.emplace_back(source);
-    }
-
-    while(!pq_.empty()) {
-        const auto [current_node, current_dist] = pq_.top();
-
-        settle(current_node);
-
-        if(current_node == target) {
-            return current_dist > dist;
-        }
-
-        if(current_dist > dist) {
-            return true;
-        }
-
-        //pop after the return, otherwise we loose a value
-        //when reusing the pq
-        pq_.pop();
-
-        const auto edge_ids = graph_.relaxEdgeIds(current_node);
-
-        for(auto edge_id : edge_ids) {
-            const auto& e = graph_.getEdge(edge_id);
-            if(e.target == u or graph_.nodeContracted(e.target)) {
-                continue;
-            }
-            auto neig_dist = getDistanceTo(e.target);
-            const auto new_dist = current_dist + e.dist;
-
-            if(UNREACHABLE != current_dist and neig_dist > new_dist) {
-                touched_.emplace_back(e.target);
-                setDistanceTo(e.target, new_dist);
-                pq_.emplace(e.target, new_dist);
-                previous_nodes_[e.target] = current_node;
-            }
-        }
-    }
-    return true;
-}
-
-auto Dijkstra::findDistance(NodeId source, NodeId target) noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::findDistance(NodeId source, NodeId target) noexcept
     -> Distance
 {
     return computeDistance(source, target);
 }
 
-auto Dijkstra::getDistanceTo(NodeId n) const noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::getDistanceTo(NodeId n) const noexcept
     -> Distance
 {
     return distances_[n];
 }
 
-auto Dijkstra::setDistanceTo(NodeId n, Distance distance) noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::setDistanceTo(NodeId n, Distance distance) noexcept
     -> void
 {
     distances_[n] = distance;
 }
 
-auto Dijkstra::extractShortestPath(NodeId source, NodeId target) const noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::extractShortestPath(NodeId source, NodeId target) const noexcept
     -> DijkstraPath
 {
     //check if a path exists
@@ -157,7 +105,8 @@ auto Dijkstra::extractShortestPath(NodeId source, NodeId target) const noexcept
     return std::tuple{path, getDistanceTo(target), q_pops_};
 }
 
-auto Dijkstra::reset() noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::reset() noexcept
     -> void
 {
     for(auto n : touched_) {
@@ -170,25 +119,29 @@ auto Dijkstra::reset() noexcept
     q_pops_ = 0;
 }
 
-auto Dijkstra::unSettle(NodeId n)
+template<class GraphType>
+auto BasicDijkstra<GraphType>::unSettle(NodeId n)
     -> void
 {
     settled_[n] = false;
 }
 
-auto Dijkstra::settle(NodeId n) noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::settle(NodeId n) noexcept
     -> void
 {
     settled_[n] = true;
 }
 
-auto Dijkstra::isSettled(NodeId n)
+template<class GraphType>
+auto BasicDijkstra<GraphType>::isSettled(NodeId n)
     -> bool
 {
     return settled_[n];
 }
 
-auto Dijkstra::computeDistance(NodeId source, NodeId target) noexcept
+template<class GraphType>
+auto BasicDijkstra<GraphType>::computeDistance(NodeId source, NodeId target) noexcept
     -> Distance
 {
     if(source == last_source_
@@ -217,20 +170,20 @@ auto Dijkstra::computeDistance(NodeId source, NodeId target) noexcept
         //when reusing the pq
         pq_.pop();
 
-        const auto edge_ids = graph_.relaxEdgeIds(current_node);
-
-        for(auto edge_id : edge_ids) {
-            const Edge& e = graph_.getEdge(edge_id);
-            auto neig_dist = getDistanceTo(e.target);
-            const auto new_dist = current_dist + e.dist;
+        graph_.forEachEdge(current_node, [&](auto target, auto dist) {
+            auto neig_dist = getDistanceTo(target);
+            const auto new_dist = current_dist + dist;
 
             if(UNREACHABLE != current_dist and neig_dist > new_dist) {
-                touched_.emplace_back(e.target);
-                setDistanceTo(e.target, new_dist);
-                pq_.emplace(e.target, new_dist);
+                touched_.emplace_back(target);
+                setDistanceTo(target, new_dist);
+                pq_.emplace(target, new_dist);
             }
-        }
+        });
     }
 
     return getDistanceTo(target);
 }
+
+template class BasicDijkstra<Graph>;
+template class BasicDijkstra<ImplicitGridGraph>;
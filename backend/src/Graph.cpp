@@ -1,93 +1,304 @@
-#include <Dijkstra.hpp>
+#include <ContractionGraph.hpp>
 #include <Graph.hpp>
+#include <MappedFile.hpp>
 #include <Range.hpp>
 #include <SphericalGrid.hpp>
 #include <Vector3D.hpp>
+#include <WitnessSearch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <execution>
+#include <functional>
 #include <fmt/ranges.h>
 #include <iostream>
 #include <nonstd/span.hpp>
 #include <numeric>
 #include <queue>
+#include <thread>
 #include <unordered_set>
 
+namespace {
+
+// "SRGRAPH" followed by a zero byte
+constexpr auto GRAPH_FILE_MAGIC = std::uint64_t{0x0048504152475253ull};
+constexpr auto GRAPH_FILE_VERSION = std::uint32_t{9};
+
+// the widths of the ids and distances the snapshot was written with
+constexpr auto INDEX_BITS = std::uint32_t{SHIPROUTER_INDEX_BITS};
+constexpr auto WEIGHT_BITS = std::uint32_t{SHIPROUTER_WEIGHT_BITS};
+
+// position of the point on a hilbert curve through a 2^16 x 2^16 raster of the lat/lng plane
+auto hilbertKey(Latitude<Degree> lat, Longitude<Degree> lng) noexcept
+    -> std::uint32_t
+{
+    constexpr auto SIDE = std::uint32_t{1} << 16;
+    const auto toCell = [](double offset, double extent) {
+        const auto cell = std::floor(offset / extent * SIDE);
+        return static_cast<std::uint32_t>(std::clamp(cell, 0.0, static_cast<double>(SIDE - 1)));
+    };
+
+    auto x = toCell(lng.getValue() + 180.0, 360.0);
+    auto y = toCell(lat.getValue() + 90.0, 180.0);
+    std::uint32_t key = 0;
+    for(auto s = SIDE / 2; s > 0; s /= 2) {
+        const auto rx = (x & s) > 0 ? 1u : 0u;
+        const auto ry = (y & s) > 0 ? 1u : 0u;
+        key += s * s * ((3 * rx) ^ ry);
+
+        // rotate the quadrant, such that the curve stays continuous
+        if(ry == 0) {
+            if(rx == 1) {
+                x = SIDE - 1 - x;
+                y = SIDE - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return key;
+}
+
+// NON_EXISTENT is reserved, every other id has to fit into NodeId/EdgeId. ids which do
+// not fit would wrap around and corrupt the graph, so the preprocessing stops here
+auto ensureIdsFit(std::size_t count, std::string_view what) noexcept
+    -> void
+{
+    if(count >= NON_EXISTENT) {
+        fmt::print("the ids of {} {} do not fit into {} bits, build with SHIPROUTER_INDEX_BITS=64\n",
+                   count,
+                   what,
+                   INDEX_BITS);
+        std::abort();
+    }
+}
+
+} // namespace
 
 Graph::Graph(SphericalGrid&& g)
-    : offset_(g.size() + 1, 0),
-      snap_settled_(g.size(), false),
-      levels(g.size(), 0),
+    : Graph(std::move(g), nullptr) {}
+
+Graph::Graph(SphericalGrid&& g, const Graph& previous)
+    : Graph(std::move(g), &previous) {}
+
+Graph::Graph(SphericalGrid&& g, const Graph* previous)
+    : grid_to_node_(g.size(), NON_EXISTENT),
       grid_(std::move(g))
 {
-    for(auto id : utils::range(grid_.size())) {
-        if(!grid_.indexIsLand(id)) {
-            auto neigs = grid_.getNeighbours(id);
-
-            std::sort(std::begin(neigs),
-                      std::end(neigs));
-            auto remove_iter =
-                std::unique(std::begin(neigs),
-                            std::end(neigs));
-
-            neigs.erase(remove_iter, std::end(neigs));
-
-            std::vector<Edge> neig_dist;
-            std::transform(std::begin(neigs),
-                           std::end(neigs),
-                           std::back_inserter(neig_dist),
-                           [&](auto neig) {
-                               auto [start_lat, start_lng] = grid_.idToLatLng(id);
-                               auto [dest_lat, dest_lng] = grid_.idToLatLng(neig);
-                               auto distance = ::distanceBetween(start_lat, start_lng, dest_lat, dest_lng);
-
-                               return Edge{id, neig, static_cast<Distance>(distance), std::nullopt};
-                           });
-
-            auto numEdgesOld = edges_.size();
-            for(auto i = 0; i < neig_dist.size(); ++i) {
-                auto edge_id = numEdgesOld + i;
-                sorted_edge_ids_.emplace_back(edge_id);
-                sorted_edge_ids_with_source_.emplace_back(edge_id, id);
+    // water nodes ordered along the hilbert curve, ties by grid id
+    const auto grid_range = utils::range(grid_.size());
+    std::copy_if(std::cbegin(grid_range),
+                 std::cend(grid_range),
+                 std::back_inserter(node_to_grid_),
+                 [&](auto grid_id) {
+                     return grid_.indexIsWater(grid_id);
+                 });
+
+    std::vector<std::pair<std::uint32_t, std::size_t>> keys(node_to_grid_.size());
+    std::transform(std::execution::par,
+                   std::cbegin(node_to_grid_),
+                   std::cend(node_to_grid_),
+                   std::begin(keys),
+                   [&](auto grid_id) {
+                       return std::pair{hilbertKey(grid_.lats_view_[grid_id], grid_.lngs_view_[grid_id]),
+                                        grid_id};
+                   });
+    std::sort(std::execution::par, std::begin(keys), std::end(keys));
+    std::transform(std::cbegin(keys),
+                   std::cend(keys),
+                   std::begin(node_to_grid_),
+                   [](const auto& key) {
+                       return key.second;
+                   });
+    keys = {};
+    node_to_grid_view_ = nonstd::span<const std::size_t>{node_to_grid_.data(), node_to_grid_.size()};
+
+    ensureIdsFit(node_to_grid_.size(), "nodes");
+
+    const auto number_of_nodes = static_cast<NodeId>(node_to_grid_.size());
+    const auto node_range = utils::range(number_of_nodes);
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      grid_to_node_[node_to_grid_[node]] = node;
+                  });
+    grid_to_node_view_ = nonstd::span<const NodeId>{grid_to_node_.data(), grid_to_node_.size()};
+
+    offset_.resize(number_of_nodes + 1, 0);
+    levels.resize(number_of_nodes, 0);
+    levels_view_ = nonstd::span<const Level>{levels.data(), levels.size()};
+
+    // sorted neighbours without duplicates. the buffer belongs to the
+    // calling thread and keeps its capacity, nodes do not allocate on their own
+    const auto collectNeighbours = [&](NodeId node) -> const std::vector<NodeId>& {
+        thread_local std::vector<NodeId> neighbours;
+        neighbours.clear();
+        const auto [m, n] = grid_.idToGrid(node_to_grid_[node]);
+        grid_.forEachNeighbour(m, n, [&](auto neig) {
+            if(!grid_.indexIsLand(neig)) {
+                neighbours.emplace_back(grid_to_node_[neig]);
             }
-            edges_ = concat(std::move(edges_),
-                            std::move(neig_dist));
-        }
+        });
 
-        offset_[id + 1] = edges_.size();
+        std::sort(std::begin(neighbours),
+                  std::end(neighbours));
+        neighbours.erase(std::unique(std::begin(neighbours),
+                                     std::end(neighbours)),
+                         std::end(neighbours));
+        return neighbours;
+    };
+
+    // the nodes whose neighbours on the grid kept their land/water state
+    // have the same edges as in the previous graph, they are copied from it
+    std::vector<bool> reuse_edges;
+    std::vector<std::size_t> previous_offset;
+    std::vector<HotEdge> previous_edges;
+    if(previous) {
+        std::tie(previous_offset, previous_edges) = previous->baseEdges();
+        reuse_edges.assign(number_of_nodes, true);
+
+        const auto markChanged = [&](auto grid_id) {
+            if(grid_to_node_[grid_id] != NON_EXISTENT) {
+                reuse_edges[grid_to_node_[grid_id]] = false;
+            }
+        };
+
+        // the neighbourhood on the grid is symmetric, the nodes next to a
+        // changed node are the ones it has as neighbours itself
+        const auto mask = grid_.is_water_view_;
+        const auto previous_mask = previous->grid_.is_water_view_;
+        for(auto word : utils::range(mask.size())) {
+            const auto changed = mask[word] ^ previous_mask[word];
+            if(changed == 0) {
+                continue;
+            }
+            for(auto bit : utils::range(64)) {
+                if((changed >> bit) & 1) {
+                    const auto grid_id = word * 64 + bit;
+                    const auto [m, n] = grid_.idToGrid(grid_id);
+                    markChanged(grid_id);
+                    grid_.forEachNeighbour(m, n, markChanged);
+                }
+            }
+        }
 
-        auto [m, n] = grid_.idToGrid(id);
-        ns_.emplace_back(n);
-        ms_.emplace_back(m);
+        fmt::print("took the edges of {} of {} nodes from the previous graph\n",
+                   std::count(std::cbegin(reuse_edges), std::cend(reuse_edges), true),
+                   number_of_nodes);
     }
+
+    // the base edges of the node in the previous graph, with their previous targets
+    const auto previousEdgesOf = [&](NodeId node) {
+        const auto previous_node = previous->fromGridId(node_to_grid_[node]);
+        return nonstd::span<const HotEdge>{previous_edges.data() + previous_offset[previous_node],
+                                           previous_edges.data() + previous_offset[previous_node + 1]};
+    };
+
+    // first pass: count the edges of every node and sum them up into the offsets
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      offset_[node + 1] = previous and reuse_edges[node]
+                          ? previousEdgesOf(node).size()
+                          : collectNeighbours(node).size();
+                  });
+    std::inclusive_scan(std::execution::par,
+                        std::cbegin(offset_),
+                        std::cend(offset_),
+                        std::begin(offset_));
+
+    // second pass: every node writes its edges into its own part of the array
+    const auto number_of_edges = offset_.back();
+    ensureIdsFit(number_of_edges, "edges");
+    edges_.resize(number_of_edges, Edge{0, 0, 0, std::nullopt});
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      auto edge_id = offset_[node];
+                      if(previous and reuse_edges[node]) {
+                          // the order of the nodes which are in both graphs does not change
+                          for(const auto& edge : previousEdgesOf(node)) {
+                              const auto target = grid_to_node_[previous->toGridId(edge.target)];
+                              edges_[edge_id++] = Edge{node, target, edge.dist, std::nullopt};
+                          }
+                          return;
+                      }
+
+                      const auto start_lat = idToLat(node);
+                      const auto start_lng = idToLng(node);
+                      for(auto neig : collectNeighbours(node)) {
+                          const auto distance = ::distanceBetween(start_lat, start_lng, idToLat(neig), idToLng(neig));
+                          edges_[edge_id++] = Edge{node, neig, static_cast<Distance>(distance), std::nullopt};
+                      }
+                  });
+
+    sorted_edge_ids_.resize(number_of_edges);
+    std::iota(std::begin(sorted_edge_ids_),
+              std::end(sorted_edge_ids_),
+              EdgeId{0});
+    rebuildHotEdges();
+
+    // the targets of the edges of a node are sorted, the inverse edge is found by binary search
     fmt::print("Checking if we have inverse edges for every edge...\n");
-    for(auto i = 0; i < edges_.size(); ++i) {
-        auto inv_edge = inverseEdge(i);
+    const auto missing = std::count_if(std::execution::par,
+                                       std::cbegin(edges_),
+                                       std::cend(edges_),
+                                       [&](const Edge& edge) {
+                                           const auto begin = std::cbegin(edges_) + offset_[edge.target];
+                                           const auto end = std::cbegin(edges_) + offset_[edge.target + 1];
+                                           const auto inverse = std::lower_bound(begin,
+                                                                                 end,
+                                                                                 edge.source,
+                                                                                 [](const Edge& candidate, auto source) {
+                                                                                     return candidate.target < source;
+                                                                                 });
+                                           return inverse == end or inverse->target != edge.source;
+                                       });
+    if(missing > 0) {
+        fmt::print("Did not find inverse edges for {} edges!! Something is wrong with the graph.\n", missing);
     }
+}
 
-    //insert dummy at the end
-    // edges_.emplace_back(std::numeric_limits<NodeId>::max(), UNREACHABLE, std::nullopt);
+auto Graph::toGridId(NodeId node) const noexcept
+    -> std::size_t
+{
+    return node_to_grid_view_[node];
+}
+
+auto Graph::fromGridId(std::size_t grid_id) const noexcept
+    -> NodeId
+{
+    if(grid_id >= grid_to_node_view_.size()) {
+        return NON_EXISTENT;
+    }
+    return grid_to_node_view_[grid_id];
 }
 
 auto Graph::idToLat(NodeId id) const noexcept
     -> Latitude<Degree>
 {
-    return grid_.lats_[id];
+    return grid_.lats_view_[node_to_grid_view_[id]];
 }
 
 auto Graph::idToLng(NodeId id) const noexcept
     -> Longitude<Degree>
 {
-    return grid_.lngs_[id];
+    return grid_.lngs_view_[node_to_grid_view_[id]];
 }
 
 auto Graph::idToM(NodeId id) const noexcept
     -> std::size_t
 {
-    return ms_[id];
+    return grid_.idToGrid(node_to_grid_view_[id]).first;
 }
 
 auto Graph::idToN(NodeId id) const noexcept
     -> std::size_t
 {
-    return ns_[id];
+    return grid_.idToGrid(node_to_grid_view_[id]).second;
 }
 
 auto Graph::isValidId(NodeId id) const noexcept
@@ -99,7 +310,7 @@ auto Graph::isValidId(NodeId id) const noexcept
 auto Graph::size() const noexcept
     -> std::size_t
 {
-    return grid_.lats_.size();
+    return node_to_grid_view_.size();
 }
 
 auto Graph::relaxEdgeIds(NodeId node) const noexcept
@@ -112,79 +323,90 @@ auto Graph::relaxEdgeIds(NodeId node) const noexcept
     return nonstd::span{start, end};
 }
 
-auto Graph::gridToId(std::size_t m, std::size_t n) const noexcept
-    -> NodeId
+auto Graph::relaxEdges(NodeId node) const noexcept
+    -> nonstd::span<const HotEdge>
 {
-    return grid_.gridToID(m, n);
+    const auto start = hot_edges_.data() + offset_[node];
+    const auto end = hot_edges_.data() + offset_[node + 1];
+    return nonstd::span{start, end};
 }
 
-auto Graph::isLandNode(NodeId node) const noexcept
-    -> bool
+auto Graph::upwardEdges(NodeId node) const noexcept
+    -> nonstd::span<const HotEdge>
 {
-    return !grid_.is_water_[node];
+    const auto start = upward_edges_view_.data() + upward_offset_view_[node];
+    const auto end = upward_edges_view_.data() + upward_offset_view_[node + 1];
+    return nonstd::span{start, end};
 }
 
-const Edge& Graph::getEdge(EdgeId edge_id) const noexcept
+auto Graph::upwardEdgeId(NodeId node, std::size_t i) const noexcept
+    -> EdgeId
 {
-    return edges_[edge_id];
+    return upward_edge_ids_view_[upward_offset_view_[node] + i];
+}
+
+auto Graph::gridToId(std::size_t m, std::size_t n) const noexcept
+    -> NodeId
+{
+    return fromGridId(grid_.gridToID(m, n));
 }
 
 Level Graph::getLevel(NodeId node) const noexcept
 {
-    return levels[node];
+    return levels_view_[node];
 }
 
 
 auto Graph::getRowGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-    -> std::vector<NodeId>
+    -> std::vector<std::size_t>
 {
     auto on_grid = grid_.getRowNeighbours(m, n);
-    std::vector<NodeId> ids;
+    std::vector<std::size_t> ids;
     std::transform(std::begin(on_grid),
                    std::end(on_grid),
                    std::back_inserter(ids),
                    [&](auto pair) {
                        auto [m, n] = pair;
-                       return gridToId(m, n);
+                       return grid_.gridToID(m, n);
                    });
 
     return ids;
 }
 
 auto Graph::getLowerGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-    -> std::vector<NodeId>
+    -> std::vector<std::size_t>
 {
     auto on_grid = grid_.getLowerNeighbours(m, n);
-    std::vector<NodeId> ids;
+    std::vector<std::size_t> ids;
     std::transform(std::begin(on_grid),
                    std::end(on_grid),
                    std::back_inserter(ids),
                    [&](auto pair) {
                        auto [m, n] = pair;
-                       return gridToId(m, n);
+                       return grid_.gridToID(m, n);
                    });
 
     return ids;
 }
 
 auto Graph::getUpperGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-    -> std::vector<NodeId>
+    -> std::vector<std::size_t>
 {
     auto on_grid = grid_.getUpperNeighbours(m, n);
-    std::vector<NodeId> ids;
+    std::vector<std::size_t> ids;
     std::transform(std::begin(on_grid),
                    std::end(on_grid),
                    std::back_inserter(ids),
                    [&](auto pair) {
                        auto [m, n] = pair;
-                       return gridToId(m, n);
+                       return grid_.gridToID(m, n);
                    });
 
     return ids;
 }
 
 auto Graph::getGridNeigboursOf(std::size_t m, std::size_t n) const noexcept
-    -> std::vector<NodeId>
+    -> std::vector<std::size_t>
 {
     return concat(getUpperGridNeigboursOf(m, n),
                   getLowerGridNeigboursOf(m, n),
@@ -197,14 +419,16 @@ auto Graph::getSnapNodeCandidate(Latitude<Degree> lat,
 {
     const auto [m, n] = grid_.sphericalToGrid(lat.toRadian(), lng.toRadian());
 
-    const auto id = gridToId(m, n);
+    const auto id = grid_.gridToID(m, n);
 
     fmt::print("index: {}\n", id);
 
-    std::vector<NodeId> candidates;
-    std::vector<NodeId> touched_nodes;
+    // the search runs over the grid, including its land nodes
+    std::vector<std::size_t> candidates;
+    std::vector<std::size_t> touched_nodes;
+    snap_settled_.resize(grid_.size(), false);
 
-    if(!isLandNode(id)) {
+    if(grid_.indexIsWater(id)) {
         candidates.emplace_back(id);
     }
 
@@ -215,7 +439,7 @@ auto Graph::getSnapNodeCandidate(Latitude<Degree> lat,
         workstack.pop_back();
         touched_nodes.emplace_back(candidate);
 
-        if(!isLandNode(candidate)) {
+        if(grid_.indexIsWater(candidate)) {
             candidates.emplace_back(candidate);
             continue;
         }
@@ -224,9 +448,9 @@ auto Graph::getSnapNodeCandidate(Latitude<Degree> lat,
             continue;
         }
 
+        const auto [candidate_m, candidate_n] = grid_.idToGrid(candidate);
         workstack = concat(std::move(workstack),
-                           getGridNeigboursOf(ms_[candidate],
-                                              ns_[candidate]));
+                           getGridNeigboursOf(candidate_m, candidate_n));
         snap_settled_[candidate] = true;
     }
 
@@ -234,18 +458,19 @@ auto Graph::getSnapNodeCandidate(Latitude<Degree> lat,
         snap_settled_[touched] = false;
     }
 
-    return *std::min_element(std::cbegin(candidates),
-                             std::cend(candidates),
-                             [&](auto lhs, auto rhs) {
-                                 auto lhs_lat = grid_.lats_[lhs];
-                                 auto lhs_lng = grid_.lngs_[lhs];
+    const auto best = *std::min_element(std::cbegin(candidates),
+                                        std::cend(candidates),
+                                        [&](auto lhs, auto rhs) {
+                                            auto lhs_lat = grid_.lats_view_[lhs];
+                                            auto lhs_lng = grid_.lngs_view_[lhs];
 
-                                 auto rhs_lat = grid_.lats_[rhs];
-                                 auto rhs_lng = grid_.lngs_[rhs];
+                                            auto rhs_lat = grid_.lats_view_[rhs];
+                                            auto rhs_lng = grid_.lngs_view_[rhs];
 
-                                 return ::distanceBetween(lat, lng, lhs_lat, lhs_lng)
-                                     < ::distanceBetween(lat, lng, rhs_lat, rhs_lng);
-                             });
+                                            return ::distanceBetween(lat, lng, lhs_lat, lhs_lng)
+                                                < ::distanceBetween(lat, lng, rhs_lat, rhs_lng);
+                                        });
+    return fromGridId(best);
 }
 
 auto Graph::snapToGridNode(Latitude<Degree> lat,
@@ -257,19 +482,23 @@ auto Graph::snapToGridNode(Latitude<Degree> lat,
     std::priority_queue candidates(
         [&](auto id1, auto id2) {
             return ::distanceBetween(lat, lng,
-                                     grid_.lats_[id1],
-                                     grid_.lngs_[id1])
+                                     idToLat(id1),
+                                     idToLng(id1))
                 > ::distanceBetween(lat, lng,
-                                    grid_.lats_[id2],
-                                    grid_.lngs_[id2]);
+                                    idToLat(id2),
+                                    idToLng(id2));
         },
         std::vector{candidate});
 
+    // walk over the neighbours on the grid, the edges of a contracted graph are not kept
     while(true) {
         const auto best_before_insert = candidates.top();
-        for(auto edge_id : relaxEdgeIds(best_before_insert)) {
-            candidates.emplace(edges_[edge_id].target);
-        }
+        const auto [m, n] = grid_.idToGrid(toGridId(best_before_insert));
+        grid_.forEachNeighbour(m, n, [&](auto grid_id) {
+            if(const auto neighbour = fromGridId(grid_id); neighbour != NON_EXISTENT) {
+                candidates.emplace(neighbour);
+            }
+        });
         const auto best_after_insert = candidates.top();
 
         if(best_before_insert == best_after_insert) {
@@ -282,28 +511,28 @@ auto Graph::snapToGridNode(Latitude<Degree> lat,
 
 std::vector<std::pair<NodeId, NodeId>> Graph::randomSTPairs(uint amount) const noexcept
 {
+    // every node is a water node
     std::vector<std::pair<NodeId, NodeId>> st_pairs;
     while(st_pairs.size() < amount) {
-        auto source = rand() % size();
-        auto target = rand() % size();
-        if(grid_.is_water_[source] and grid_.is_water_[target]) {
-            st_pairs.emplace_back(source, target);
-        }
+        NodeId source = rand() % size();
+        NodeId target = rand() % size();
+        st_pairs.emplace_back(source, target);
     }
     return st_pairs;
 }
 
 Path Graph::unwrapEdge(EdgeId edge_id, NodeId target) const noexcept
 {
-    const Edge& edge = edges_[edge_id];
-    if(!edge.wrapped_edges) {
+    const auto& edge = unwrap_edges_view_[edge_id];
+    if(edge.first_wrapped == NON_EXISTENT) {
         if(edge.source == target) {
             return std::vector<NodeId>{edge.target};
         } else if(edge.target == target) {
             return std::vector<NodeId>{edge.source};
         }
     }
-    auto [edge1, edge2] = edge.wrapped_edges.value();
+    const auto edge1 = edge.first_wrapped;
+    const auto edge2 = edge.second_wrapped;
     auto path_edge2 = unwrapEdge(edge2, target);
     auto path = unwrapEdge(edge1, path_edge2[0]);
     path.insert(path.end(), path_edge2.begin(), path_edge2.end());
@@ -312,32 +541,164 @@ Path Graph::unwrapEdge(EdgeId edge_id, NodeId target) const noexcept
 
 // === stuff for ch and contraction === //
 
-void Graph::contract() noexcept
+// witness search of one thread and the shortcuts it found in the current step,
+// the buffers keep their memory for the following steps
+struct Graph::ContractionWorker
+{
+    WitnessSearch witness_search;
+    std::vector<Edge> shortcuts;
+    std::vector<NodeId> targets;
+};
+
+namespace {
+
+// witness search of one thread of the contraction by priority. the shortcuts
+// are those of the node whose priority was computed last
+struct PriorityWorker
+{
+    ContractionWitnessSearch witness_search;
+    std::vector<NodeId> targets;
+    std::vector<std::tuple<ContractionGraph::Arc, ContractionGraph::Arc, Distance>> shortcuts;
+};
+
+// a node of the independent set, its shortcuts are
+// shortcuts[first, first + count) of the worker which checked it
+struct ContractionCandidate
+{
+    NodeId node;
+    int32_t edge_diff;
+    std::size_t worker;
+    std::size_t first;
+    std::size_t count;
+};
+
+// weights of the terms of a node's priority in the priority queue order,
+// the node with the lowest weighted sum is contracted next
+constexpr auto EDGE_DIFF_WEIGHT = std::int64_t{2};
+constexpr auto ORIGINAL_EDGES_WEIGHT = std::int64_t{1};
+constexpr auto DELETED_NEIGHBOURS_WEIGHT = std::int64_t{1};
+constexpr auto DEPTH_WEIGHT = std::int64_t{4};
+
+// the contraction workers needed for the threads of the machine
+auto numberOfContractionWorkers() noexcept
+    -> std::size_t
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+auto printWitnessSearchStatistics(const WitnessSearchStatistics& statistics) noexcept
+    -> void
+{
+    fmt::print("{} witness searches, {} stopped at the hop limit, {} at the settled node limit\n",
+               statistics.searches,
+               statistics.hop_limit_hits,
+               statistics.settle_limit_hits);
+}
+
+// calls `callback(worker, idx)` for every idx in [0, count) in parallel. every worker
+// takes small blocks of indices until none are left, such that expensive
+// indices do not keep the other threads waiting
+template<class Callback>
+auto forEachInBlocks(std::size_t number_of_workers, std::size_t count, Callback&& callback) noexcept
+    -> void
+{
+    constexpr auto BLOCK_SIZE = std::size_t{64};
+    std::atomic<std::size_t> next_block{0};
+    const auto worker_range = utils::range(number_of_workers);
+    std::for_each(std::execution::par,
+                  std::cbegin(worker_range),
+                  std::cend(worker_range),
+                  [&](auto worker_idx) {
+                      for(auto first = next_block.fetch_add(BLOCK_SIZE);
+                          first < count;
+                          first = next_block.fetch_add(BLOCK_SIZE)) {
+                          const auto last = std::min(first + BLOCK_SIZE, count);
+                          for(auto idx = first; idx < last; idx++) {
+                              callback(worker_idx, idx);
+                          }
+                      }
+                  });
+}
+
+} // namespace
+
+void Graph::contract(ContractionOrder order, WitnessSearchLimits limits) noexcept
 {
     fmt::print("Starting graph contraction...\n");
-    Dijkstra dijkstra{*this};
+    const auto number_of_edges = edges_.size();
+    contraction_order_ = order;
+    witness_search_limits_ = limits;
+
+    if(order == ContractionOrder::PRIORITY_QUEUE) {
+        contractByPriority(limits);
+    } else {
+        contractInSteps(limits, nullptr);
+    }
+
+    fmt::print("Done contracting with {} levels and {} shortcuts\n",
+               current_level,
+               edges_.size() - number_of_edges);
+
+    buildUpwardGraph();
+    fmt::print("Kept {} upward edges for the queries\n", upward_edges_view_.size());
+}
+
+void Graph::contractInOrderOf(const Graph& previous) noexcept
+{
+    fmt::print("Starting graph contraction in the order of the previous graph...\n");
+    const auto number_of_edges = edges_.size();
+    contraction_order_ = previous.contraction_order_;
+    witness_search_limits_ = previous.witness_search_limits_;
+
+    // the nodes are ranked by their level in the previous graph, new nodes come first
+    std::vector<Level> ranks(size());
+    const auto node_range = utils::range(size());
+    std::transform(std::execution::par,
+                   std::cbegin(node_range),
+                   std::cend(node_range),
+                   std::begin(ranks),
+                   [&](auto node) {
+                       const auto previous_node = previous.fromGridId(toGridId(node));
+                       return previous_node == NON_EXISTENT ? Level{0} : previous.getLevel(previous_node);
+                   });
+    contractInSteps(witness_search_limits_, &ranks);
+
+    fmt::print("Done contracting with {} levels and {} shortcuts\n",
+               current_level,
+               edges_.size() - number_of_edges);
+
+    buildUpwardGraph();
+    fmt::print("Kept {} upward edges for the queries\n", upward_edges_view_.size());
+}
+
+void Graph::contractInSteps(WitnessSearchLimits limits, const std::vector<Level>* ranks) noexcept
+{
+    // one witness search for every thread, the nodes of an independent set
+    // do not share edges and are checked concurrently
+    std::vector<ContractionWorker> workers;
+    workers.reserve(numberOfContractionWorkers());
+    for(auto i = 0u; i < numberOfContractionWorkers(); i++) {
+        workers.push_back(ContractionWorker{WitnessSearch{*this, limits}, {}, {}});
+    }
+
     while(!fully_contracted) {
-        // fmt::print("Graph contains {} nodes\n", size());
-        // fmt::print("Edges:\n");
-        // for(auto i = 0; i < size(); ++i) {
-        //     fmt::print("{} is water: {}\n", i, grid_.is_water_[i]);
-        //     for(auto edge_id : relaxEdgeIds(i)) {
-        //         auto edge = edges_[edge_id];
-        //         fmt::print("{} -> {}: {} {}\n", edge.source, edge.target, edge.dist, edge.wrapped_edges.has_value());
-        //     }
-        //     fmt::print("\n");
-        // }
-        contractionStep(dijkstra);
+        contractionStep(workers, ranks);
     }
-    fmt::print("Done contracting with {} levels\n", current_level);
+
+    WitnessSearchStatistics statistics;
+    for(const auto& worker : workers) {
+        statistics += worker.witness_search.getStatistics();
+    }
+    printWitnessSearchStatistics(statistics);
 }
 
-void Graph::contractionStep(Dijkstra& dijkstra) noexcept
+void Graph::contractionStep(std::vector<ContractionWorker>& workers,
+                            const std::vector<Level>* ranks) noexcept
 {
     fmt::print("Graph has {} edges\n", edges_.size());
     /*
     * 1. create independent set of nodes
-    * 2. for each node: 
+    * 2. for each node (in parallel):
     *      calculate distances from and to all neighbors and node edge diff
     * 3. sort by edge diff ascending
     * 4. Create shortcuts for the first n nodes (with lowest edge diff)
@@ -345,30 +706,48 @@ void Graph::contractionStep(Dijkstra& dijkstra) noexcept
       */
 
     // 1.
-    auto indep_nodes = independentSet();
-    // fmt::print("Independent set contains {} nodes: {}\n", indep_nodes.size(), indep_nodes);
+    auto indep_nodes = ranks ? independentSet(*ranks) : independentSet();
     if(indep_nodes.empty()) {
         fully_contracted = true;
         return;
     }
 
     // 2.
-    // holds the edge_diff and new_edges for every node in the independent set
-    std::vector<std::tuple<NodeId, int32_t, std::vector<Edge>>> newEdgeCandidates;
-    for(auto node : indep_nodes) {
-        // fmt::print("Contracting node {}\n", node);
-        std::vector<Edge> new_edges;
+    // holds the edge_diff and the range of the new edges for every node in the
+    // independent set, every node writes only into its own slot
+    std::vector<ContractionCandidate> newEdgeCandidates(indep_nodes.size());
+    const auto checkNode = [&](std::size_t worker_idx, std::size_t idx) {
+        auto& witness_search = workers[worker_idx].witness_search;
+        auto& new_edges = workers[worker_idx].shortcuts;
+        auto& targets = workers[worker_idx].targets;
+        const auto node = indep_nodes[idx];
+        const auto first_new_edge = new_edges.size();
         auto edge_ids = relaxEdgeIds(node);
         auto numContractedNeighbors = 0;
 
-        for(auto i = 0; i < edge_ids.size(); ++i) {
+        for(std::size_t i = 0; i < edge_ids.size(); ++i) {
             auto edge_id1 = edge_ids[i];
             auto source = edges_[edge_id1].target;
             if(nodeContracted(source)) {
                 numContractedNeighbors++;
                 continue;
             }
-            // shortest path from neigh to all other neighbors
+
+            // one search from the neighbour to all following neighbors
+            targets.clear();
+            Distance max_cost = 0;
+            for(auto j = i + 1; j < edge_ids.size(); ++j) {
+                const auto& edge2 = edges_[edge_ids[j]];
+                if(!nodeContracted(edge2.target)) {
+                    targets.emplace_back(edge2.target);
+                    max_cost = std::max(max_cost, edges_[edge_id1].dist + edge2.dist);
+                }
+            }
+            if(targets.empty()) {
+                continue;
+            }
+            witness_search.run(source, node, targets, max_cost);
+
             for(auto j = i + 1; j < edge_ids.size(); ++j) {
                 auto edge_id2 = edge_ids[j];
                 auto target = edges_[edge_id2].target;
@@ -376,8 +755,7 @@ void Graph::contractionStep(Dijkstra& dijkstra) noexcept
                     continue;
                 }
                 auto cost = edges_[edge_id1].dist + edges_[edge_id2].dist;
-                if(dijkstra.shortestPathContainsU(source, target, node, cost)) {
-                    // fmt::print("found shortcut with cost {}\n", cost);
+                if(witness_search.distanceTo(target) > cost) {
                     new_edges.emplace_back(
                         Edge{source,
                              target,
@@ -392,38 +770,188 @@ void Graph::contractionStep(Dijkstra& dijkstra) noexcept
                 }
             }
         }
-        auto heuristic_value = new_edges.size() - edge_ids.size() + numContractedNeighbors;
-        newEdgeCandidates.emplace_back(node, heuristic_value, new_edges);
+        const auto number_of_new_edges = new_edges.size() - first_new_edge;
+        auto heuristic_value = number_of_new_edges - edge_ids.size() + numContractedNeighbors;
+        newEdgeCandidates[idx] = ContractionCandidate{node,
+                                                      static_cast<int32_t>(heuristic_value),
+                                                      worker_idx,
+                                                      first_new_edge,
+                                                      number_of_new_edges};
+    };
+
+    for(auto& worker : workers) {
+        worker.shortcuts.clear();
     }
-    // fmt::print("Done checking for possible shortcuts\n");
+    forEachInBlocks(workers.size(), indep_nodes.size(), checkNode);
 
     // 3.
+    // ties are broken by the node id, the result does not depend on the number of threads
     std::sort(newEdgeCandidates.begin(), newEdgeCandidates.end(), [](const auto& lhs, const auto& rhs) {
-        return std::get<1>(lhs) < std::get<1>(rhs);
+        return std::tie(lhs.edge_diff, lhs.node) < std::tie(rhs.edge_diff, rhs.node);
     });
 
     // 4.
     current_level++;
-    std::vector<Edge> toInsert;
     // Alternative 1: Add shortcuts with edge_diff up to median
-    // const auto median = std::get<1>(newEdgeCandidates[newEdgeCandidates.size() / 2]);
-    // for(auto [node, edge_diff, new_edges] : newEdgeCandidates) {
-    //     if(edge_diff <= median) {
-    //         levels[node] = current_level;
-    //         toInsert = concat(std::move(toInsert), std::move(new_edges));
-    //     }
-    // }
+    // const auto median = newEdgeCandidates[newEdgeCandidates.size() / 2].edge_diff;
     // Alternative 2: Add up to 1/4 of candidates
-    for(auto i = 0; i <= newEdgeCandidates.size() / 4; ++i) {
-        auto [node, _, new_edges] = newEdgeCandidates[i];
-        levels[node] = current_level;
-        toInsert = concat(std::move(toInsert), std::move(new_edges));
+    // the nodes taken by their ranks are all contracted, their order is already known
+    const auto number_contracted = ranks ? newEdgeCandidates.size() : newEdgeCandidates.size() / 4 + 1;
+    std::size_t number_of_shortcuts = 0;
+    for(auto i : utils::range(number_contracted)) {
+        const auto& candidate = newEdgeCandidates[i];
+        levels[candidate.node] = current_level;
+        number_of_shortcuts += candidate.count;
     }
-    // fmt::print("levels {}\n", levels);
 
     // 5.
-    fmt::print("Contraction step {}: adding {} new shortcuts\n", current_level, toInsert.size());
-    insertEdges(toInsert);
+    fmt::print("Contraction step {}: adding {} new shortcuts\n", current_level, number_of_shortcuts);
+    edges_.reserve(edges_.size() + number_of_shortcuts);
+    for(auto i : utils::range(number_contracted)) {
+        const auto& candidate = newEdgeCandidates[i];
+        const auto first = std::cbegin(workers[candidate.worker].shortcuts) + candidate.first;
+        edges_.insert(std::end(edges_), first, first + candidate.count);
+    }
+    insertEdges(edges_.size() - number_of_shortcuts);
+}
+
+void Graph::contractByPriority(WitnessSearchLimits limits) noexcept
+{
+    ContractionGraph contraction_graph{size()};
+    for(auto node : utils::range(size())) {
+        for(auto edge_id : relaxEdgeIds(node)) {
+            const auto& edge = edges_[edge_id];
+            contraction_graph.addArc(node,
+                                     ContractionGraph::Arc{edge.target,
+                                                           edge.dist,
+                                                           edge_id,
+                                                           inverseEdge(edge_id),
+                                                           1});
+        }
+    }
+
+    std::vector<std::uint32_t> deleted_neighbours(size(), 0);
+    std::vector<std::uint32_t> depth(size(), 0);
+
+    // collects the pairs of arcs of the node without a witness, which need a
+    // shortcut if the node is contracted, into the shortcuts of the worker
+    const auto collectShortcuts = [&](PriorityWorker& worker, NodeId node) {
+        auto& [witness_search, targets, shortcuts] = worker;
+        shortcuts.clear();
+
+        const auto& arcs = contraction_graph.arcsOf(node);
+        for(std::size_t i = 0; i + 1 < arcs.size(); i++) {
+            targets.clear();
+            Distance max_cost = 0;
+            for(auto j = i + 1; j < arcs.size(); j++) {
+                targets.emplace_back(arcs[j].target);
+                max_cost = std::max(max_cost, arcs[i].dist + arcs[j].dist);
+            }
+            witness_search.run(arcs[i].target, node, targets, max_cost);
+
+            for(auto j = i + 1; j < arcs.size(); j++) {
+                const auto cost = arcs[i].dist + arcs[j].dist;
+                if(witness_search.distanceTo(arcs[j].target) > cost) {
+                    shortcuts.emplace_back(arcs[i], arcs[j], cost);
+                }
+            }
+        }
+    };
+
+    // the shortcuts of the node are left in the worker, the top node of
+    // the queue is contracted without running its witness searches again
+    const auto priorityOf = [&](PriorityWorker& worker, NodeId node) {
+        collectShortcuts(worker, node);
+
+        std::int64_t original_edges = 0;
+        for(const auto& [arc1, arc2, cost] : worker.shortcuts) {
+            original_edges += arc1.original_edges + arc2.original_edges;
+        }
+
+        const auto& arcs = contraction_graph.arcsOf(node);
+        for(const auto& arc : arcs) {
+            original_edges -= arc.original_edges;
+        }
+        const auto edge_diff = static_cast<std::int64_t>(worker.shortcuts.size())
+            - static_cast<std::int64_t>(arcs.size());
+
+        return EDGE_DIFF_WEIGHT * edge_diff
+            + ORIGINAL_EDGES_WEIGHT * original_edges
+            + DELETED_NEIGHBOURS_WEIGHT * deleted_neighbours[node]
+            + DEPTH_WEIGHT * depth[node];
+    };
+
+    // the first priorities do not depend on each other, they are computed in parallel
+    std::vector<PriorityWorker> workers;
+    workers.reserve(numberOfContractionWorkers());
+    for(auto i = 0u; i < numberOfContractionWorkers(); i++) {
+        workers.emplace_back(PriorityWorker{ContractionWitnessSearch{contraction_graph, limits}, {}, {}});
+    }
+    std::vector<std::int64_t> priorities(size());
+    forEachInBlocks(workers.size(), size(), [&](auto worker_idx, auto node) {
+        priorities[node] = priorityOf(workers[worker_idx], node);
+    });
+    auto& worker = workers.front();
+
+    // min-heap with lazy updates: entries whose priority is outdated are skipped,
+    // the priority of the top node is computed again before it is contracted
+    using QueueEntry = std::pair<std::int64_t, NodeId>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+    for(auto node : utils::range(size())) {
+        queue.emplace(priorities[node], node);
+    }
+
+    const auto first_shortcut = edges_.size();
+    while(!queue.empty()) {
+        const auto [priority, node] = queue.top();
+        queue.pop();
+        if(contraction_graph.nodeContracted(node) or priority != priorities[node]) {
+            continue;
+        }
+
+        priorities[node] = priorityOf(worker, node);
+        if(!queue.empty() and priorities[node] > queue.top().first) {
+            queue.emplace(priorities[node], node);
+            continue;
+        }
+
+        levels[node] = ++current_level;
+
+        for(const auto& [arc1, arc2, cost] : worker.shortcuts) {
+            ensureIdsFit(edges_.size() + 2, "edges");
+            const auto shortcut_id = static_cast<EdgeId>(edges_.size());
+            const auto inverse_id = static_cast<EdgeId>(shortcut_id + 1);
+            const auto original_edges = arc1.original_edges + arc2.original_edges;
+            edges_.emplace_back(arc1.target, arc2.target, cost, std::pair{arc1.inverse_id, arc2.id});
+            edges_.emplace_back(arc2.target, arc1.target, cost, std::pair{arc2.inverse_id, arc1.id});
+            contraction_graph.addArc(arc1.target,
+                                     ContractionGraph::Arc{arc2.target, cost, shortcut_id, inverse_id, original_edges});
+            contraction_graph.addArc(arc2.target,
+                                     ContractionGraph::Arc{arc1.target, cost, inverse_id, shortcut_id, original_edges});
+        }
+
+        // the neighbours lost an arc and got new ones, their priorities change
+        const auto arcs = contraction_graph.arcsOf(node);
+        contraction_graph.contract(node);
+        for(const auto& arc : arcs) {
+            deleted_neighbours[arc.target]++;
+            depth[arc.target] = std::max(depth[arc.target], depth[node] + 1);
+            priorities[arc.target] = priorityOf(worker, arc.target);
+            queue.emplace(priorities[arc.target], arc.target);
+        }
+    }
+
+    fmt::print("Contracted {} nodes one by one, adding {} new shortcuts\n",
+               current_level,
+               edges_.size() - first_shortcut);
+
+    WitnessSearchStatistics statistics;
+    for(const auto& priority_worker : workers) {
+        statistics += priority_worker.witness_search.getStatistics();
+    }
+    printWitnessSearchStatistics(statistics);
+    insertEdges(first_shortcut);
+    fully_contracted = true;
 }
 
 std::vector<NodeId> Graph::independentSet() const noexcept
@@ -431,7 +959,7 @@ std::vector<NodeId> Graph::independentSet() const noexcept
     std::vector<bool> visited(size(), false);
     std::vector<NodeId> indepNodes;
 
-    for(auto i = 0; i < size(); i++) {
+    for(auto i : utils::range(size())) {
         if(levels[i] == 0 && !visited[i]) {
             auto edge_ids = relaxEdgeIds(i);
             for(auto edge_id : edge_ids) {
@@ -444,67 +972,224 @@ std::vector<NodeId> Graph::independentSet() const noexcept
     return indepNodes;
 }
 
-void Graph::insertEdges(std::vector<Edge> toInsert)
+std::vector<NodeId> Graph::independentSet(const std::vector<Level>& ranks) const noexcept
 {
-    // fmt::print("Updating graph with new edges...\n");
-    for(auto new_edge : toInsert) {
-        auto source = new_edge.source;
-        // fmt::print("adding shortcut from {} to {}\n", source, new_edge.target);
-        // 1. insert new edges
-        // edges_.insert(edges_.end(),
-        //               new_edges.begin(),
-        //               new_edges.end());
-
-        // 2. clear sortedEdgeIds
-
-        // 3. consider new edges in offset array
-        for(auto i = source + 1; i < offset_.size(); i++) {
-            offset_[i] += 1;
+    // the nodes ranked below all of their uncontracted neighbours, ties are broken by the id
+    std::vector<NodeId> indepNodes;
+    for(auto i : utils::range(size())) {
+        if(levels[i] != 0) {
+            continue;
         }
-        // 3 (alt). build new offset array
-        /*
-        for(auto edge : edges_) {
-            offset_[edge.source]++;
+
+        const auto edges = relaxEdges(i);
+        const auto lowest = std::none_of(std::cbegin(edges),
+                                         std::cend(edges),
+                                         [&](const HotEdge& edge) {
+                                             const auto target = static_cast<std::size_t>(edge.target);
+                                             return levels[target] == 0
+                                                 and std::tie(ranks[target], target) < std::tie(ranks[i], i);
+                                         });
+        if(lowest) {
+            indepNodes.emplace_back(i);
         }
-        for(auto i = 1; i < offset_.size(); i++) {
-            offset_[i] += offset_[i - 1];
+    }
+    return indepNodes;
+}
+
+auto Graph::baseEdges() const noexcept
+    -> std::pair<std::vector<std::size_t>, std::vector<HotEdge>>
+{
+    // the levels of neighbours differ, every base edge is an upward edge of exactly one
+    // of its nodes. it is added to both of them, the targets are sorted afterwards
+    const auto isBaseEdge = [&](auto i) {
+        return unwrap_edges_view_[upward_edge_ids_view_[i]].first_wrapped == NON_EXISTENT;
+    };
+
+    std::vector<std::size_t> offset(size() + 1, 0);
+    for(auto node : utils::range(size())) {
+        for(auto i : utils::range(upward_offset_view_[node], upward_offset_view_[node + 1])) {
+            if(isBaseEdge(i)) {
+                offset[node + 1]++;
+                offset[upward_edges_view_[i].target + 1]++;
+            }
         }
-        offset_.emplace_back(edges_.size());
-        */
-
-        // insert new edges
-        auto numEdgesOld = edges_.size();
-        // for(auto i = 0; i < new_edges.size(); ++i) {
-        auto edge_id = numEdgesOld;
-        edges_.emplace_back(new_edge);
-        sorted_edge_ids_.emplace_back(edge_id); // only added to extend size of vector
-        sorted_edge_ids_with_source_.emplace_back(edge_id, source);
-        // }
-    }
-    // sort edges
-    std::sort(
-        sorted_edge_ids_with_source_.begin(),
-        sorted_edge_ids_with_source_.end(),
-        [&](auto pair1, auto pair2) {
-            NodeId target1 = edges_[pair1.first].target;
-            NodeId target2 = edges_[pair2.first].target;
-            // we also sort by descending level, which allows us to `break` inner loop in ch-dijkstra, instead of `continue`
-            if(pair1.second < pair2.second) {
-                return true;
-            } else if(pair1.second == pair2.second) {
-                return levels[target1] > levels[target2];
-            } else {
-                return false;
+    }
+    std::partial_sum(std::cbegin(offset),
+                     std::cend(offset),
+                     std::begin(offset));
+
+    std::vector<HotEdge> edges(offset.back());
+    auto position = offset;
+    for(auto node : utils::range(size())) {
+        for(auto i : utils::range(upward_offset_view_[node], upward_offset_view_[node + 1])) {
+            if(isBaseEdge(i)) {
+                const auto& edge = upward_edges_view_[i];
+                edges[position[node]++] = edge;
+                edges[position[edge.target]++] = HotEdge{static_cast<NodeId>(node), edge.dist};
             }
-        });
-    for(auto i = 0; i < sorted_edge_ids_with_source_.size(); i++) {
-        sorted_edge_ids_[i] = sorted_edge_ids_with_source_[i].first;
+        }
     }
+
+    const auto node_range = utils::range(size());
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      std::sort(std::begin(edges) + offset[node],
+                                std::begin(edges) + offset[node + 1],
+                                [](const auto& lhs, const auto& rhs) {
+                                    return lhs.target < rhs.target;
+                                });
+                  });
+
+    return std::pair{std::move(offset), std::move(edges)};
+}
+
+void Graph::insertEdges(std::size_t first_new_edge) noexcept
+{
+    ensureIdsFit(edges_.size(), "edges");
+
+    // counting sort of the new edges by their source: count them behind the
+    // old edges of every node and scan the counts into the new offsets
+    const auto node_range = utils::range(size());
+    new_offset_.assign(offset_.size(), 0);
+    for(auto edge_id : utils::range(first_new_edge, edges_.size())) {
+        new_offset_[edges_[edge_id].source + 1]++;
+    }
+    for(auto node : node_range) {
+        new_offset_[node + 1] += new_offset_[node] + offset_[node + 1] - offset_[node];
+    }
+
+    // the buffers of the previous step are reused, they only grow by its shortcuts
+    new_sorted_edge_ids_.resize(edges_.size());
+    insert_position_.resize(size());
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      const auto old_first = std::cbegin(sorted_edge_ids_) + offset_[node];
+                      const auto old_last = std::cbegin(sorted_edge_ids_) + offset_[node + 1];
+                      const auto last = std::copy(old_first,
+                                                  old_last,
+                                                  std::begin(new_sorted_edge_ids_) + new_offset_[node]);
+                      insert_position_[node] = std::distance(std::begin(new_sorted_edge_ids_), last);
+                  });
+    for(auto edge_id : utils::range(first_new_edge, edges_.size())) {
+        new_sorted_edge_ids_[insert_position_[edges_[edge_id].source]++] = edge_id;
+    }
+
+    // we also sort by descending level, which allows us to `break` inner loop in ch-dijkstra, instead of `continue`.
+    // the levels changed in this step, so every node is sorted again
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      std::stable_sort(std::begin(new_sorted_edge_ids_) + new_offset_[node],
+                                       std::begin(new_sorted_edge_ids_) + new_offset_[node + 1],
+                                       [&](auto edge_id1, auto edge_id2) {
+                                           return levels[edges_[edge_id1].target] > levels[edges_[edge_id2].target];
+                                       });
+                  });
+
+    // the old arrays become the buffers of the next step
+    offset_.swap(new_offset_);
+    sorted_edge_ids_.swap(new_sorted_edge_ids_);
+    rebuildHotEdges();
+}
+
+auto Graph::rebuildHotEdges() noexcept
+    -> void
+{
+    hot_edges_.resize(sorted_edge_ids_.size());
+    std::transform(std::execution::par,
+                   std::cbegin(sorted_edge_ids_),
+                   std::cend(sorted_edge_ids_),
+                   std::begin(hot_edges_),
+                   [&](auto edge_id) {
+                       const auto& edge = edges_[edge_id];
+                       return HotEdge{edge.target, edge.dist};
+                   });
+}
+
+auto Graph::buildUpwardGraph() noexcept
+    -> void
+{
+    // the edges of a node are sorted by descending level of their target,
+    // the upward edges are the front of every range
+    const auto node_range = utils::range(size());
+    upward_offset_.assign(size() + 1, 0);
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      const auto edges = relaxEdges(node);
+                      upward_offset_[node + 1] = std::count_if(std::cbegin(edges),
+                                                               std::cend(edges),
+                                                               [&](const auto& edge) {
+                                                                   return levels[edge.target] > levels[node];
+                                                               });
+                  });
+    std::inclusive_scan(std::execution::par,
+                        std::cbegin(upward_offset_),
+                        std::cend(upward_offset_),
+                        std::begin(upward_offset_));
+
+    upward_edge_ids_.resize(upward_offset_.back());
+    std::for_each(std::execution::par,
+                  std::cbegin(node_range),
+                  std::cend(node_range),
+                  [&](auto node) {
+                      const auto edge_ids = relaxEdgeIds(node);
+                      const auto count = upward_offset_[node + 1] - upward_offset_[node];
+                      std::copy(std::cbegin(edge_ids),
+                                std::cbegin(edge_ids) + count,
+                                std::begin(upward_edge_ids_) + upward_offset_[node]);
+                  });
+    rebuildUpwardEdges();
+
+    // the queries only unwrap the edges, their distances are in the upward edges
+    unwrap_edges_.resize(edges_.size());
+    std::transform(std::execution::par,
+                   std::cbegin(edges_),
+                   std::cend(edges_),
+                   std::begin(unwrap_edges_),
+                   [](const Edge& edge) {
+                       const auto [first, second] = edge.wrapped_edges.value_or(
+                           std::pair{NON_EXISTENT, NON_EXISTENT});
+                       return SnapshotEdge{edge.source, edge.target, first, second};
+                   });
+
+    upward_offset_view_ = nonstd::span<const std::size_t>{upward_offset_.data(), upward_offset_.size()};
+    upward_edge_ids_view_ = nonstd::span<const EdgeId>{upward_edge_ids_.data(), upward_edge_ids_.size()};
+    upward_edges_view_ = nonstd::span<const HotEdge>{upward_edges_.data(), upward_edges_.size()};
+    unwrap_edges_view_ = nonstd::span<const SnapshotEdge>{unwrap_edges_.data(), unwrap_edges_.size()};
+
+    edges_ = {};
+    offset_ = {};
+    sorted_edge_ids_ = {};
+    hot_edges_ = {};
+    new_offset_ = {};
+    new_sorted_edge_ids_ = {};
+    insert_position_ = {};
+}
+
+auto Graph::rebuildUpwardEdges() noexcept
+    -> void
+{
+    upward_edges_.resize(upward_edge_ids_.size());
+    std::transform(std::execution::par,
+                   std::cbegin(upward_edge_ids_),
+                   std::cend(upward_edge_ids_),
+                   std::begin(upward_edges_),
+                   [&](auto edge_id) {
+                       const auto& edge = edges_[edge_id];
+                       return HotEdge{edge.target, edge.dist};
+                   });
 }
 
 bool Graph::nodeContracted(NodeId id) const noexcept
 {
-    return levels[id] > 0;
+    return levels_view_[id] > 0;
 }
 
 EdgeId Graph::inverseEdge(EdgeId edge_id) const noexcept
@@ -519,3 +1204,114 @@ EdgeId Graph::inverseEdge(EdgeId edge_id) const noexcept
     fmt::print("Did not find inverse edge!! Something is wrong with the graph.\n");
     return -1;
 }
+
+auto Graph::saveSnapshot(const std::string& path,
+                         std::uint64_t data_checksum,
+                         std::size_t number_of_nodes) const noexcept
+    -> bool
+{
+    if(!fully_contracted) {
+        fmt::print("only contracted graphs can be written to a snapshot\n");
+        return false;
+    }
+
+    return writeFileAtomically(path, [&](BinaryWriter& writer) {
+        writer.write(GRAPH_FILE_MAGIC);
+        writer.write(GRAPH_FILE_VERSION);
+        writer.write(data_checksum);
+        writer.write(static_cast<std::uint64_t>(number_of_nodes));
+        writer.write(INDEX_BITS);
+        writer.write(WEIGHT_BITS);
+        writer.write(static_cast<std::uint32_t>(contraction_order_));
+        writer.write(witness_search_limits_.max_hops);
+        writer.write(witness_search_limits_.max_settled);
+        grid_.write(writer);
+        writer.writeArray(node_to_grid_view_);
+        writer.writeArray(grid_to_node_view_);
+        writer.writeArray(unwrap_edges_view_);
+        writer.writeArray(upward_offset_view_);
+        writer.writeArray(upward_edges_view_);
+        writer.writeArray(upward_edge_ids_view_);
+        writer.writeArray(levels_view_);
+        writer.write(current_level);
+        writer.write(static_cast<std::uint8_t>(fully_contracted));
+        return writer.good();
+    });
+}
+
+auto Graph::loadSnapshot(std::string_view path,
+                         std::uint64_t data_checksum,
+                         std::size_t number_of_nodes,
+                         ContractionOrder order,
+                         WitnessSearchLimits limits,
+                         bool prefetch) noexcept
+    -> std::optional<Graph>
+{
+    auto file = MappedFile::open(path);
+    if(!file) {
+        return std::nullopt;
+    }
+
+    if(prefetch) {
+        file->prefetch();
+    }
+
+    BinaryReader reader{file.value()};
+    if(reader.read<std::uint64_t>() != GRAPH_FILE_MAGIC
+       or reader.read<std::uint32_t>() != GRAPH_FILE_VERSION
+       or reader.read<std::uint64_t>() != data_checksum
+       or reader.read<std::uint64_t>() != number_of_nodes
+       or reader.read<std::uint32_t>() != INDEX_BITS
+       or reader.read<std::uint32_t>() != WEIGHT_BITS
+       or reader.read<std::uint32_t>() != static_cast<std::uint32_t>(order)
+       or reader.read<std::uint32_t>() != limits.max_hops
+       or reader.read<std::uint32_t>() != limits.max_settled) {
+        return std::nullopt;
+    }
+
+    // the arrays are checked against each other by their sizes only, reading
+    // their content would fault in the whole file on every start
+    auto grid = SphericalGrid::read(reader);
+    const auto node_to_grid = reader.readArray<std::size_t>();
+    const auto grid_to_node = reader.readArray<NodeId>();
+    const auto unwrap_edges = reader.readArray<SnapshotEdge>();
+    const auto upward_offset = reader.readArray<std::size_t>();
+    const auto upward_edges = reader.readArray<HotEdge>();
+    const auto upward_edge_ids = reader.readArray<EdgeId>();
+    const auto levels = reader.readArray<Level>();
+    const auto current_level = reader.read<Level>();
+    const auto fully_contracted = reader.read<std::uint8_t>();
+
+    if(!grid or !node_to_grid or !grid_to_node or !unwrap_edges or !upward_offset
+       or !upward_edges or !upward_edge_ids or !levels or !current_level or !fully_contracted) {
+        return std::nullopt;
+    }
+
+    const auto size = node_to_grid->size();
+    if(grid_to_node->size() != grid->size()
+       or upward_offset->size() != size + 1
+       or upward_offset->back() != upward_edge_ids->size()
+       or upward_edges->size() != upward_edge_ids->size()
+       or levels->size() != size) {
+        return std::nullopt;
+    }
+
+    // the data stays in the mapping, which is shared with every
+    // other process that loads the same snapshot
+    Graph graph;
+    graph.node_to_grid_view_ = node_to_grid.value();
+    graph.grid_to_node_view_ = grid_to_node.value();
+    graph.unwrap_edges_view_ = unwrap_edges.value();
+    graph.upward_offset_view_ = upward_offset.value();
+    graph.upward_edges_view_ = upward_edges.value();
+    graph.upward_edge_ids_view_ = upward_edge_ids.value();
+    graph.levels_view_ = levels.value();
+    graph.current_level = current_level.value();
+    graph.fully_contracted = fully_contracted.value() != 0;
+    graph.contraction_order_ = order;
+    graph.witness_search_limits_ = limits;
+    graph.grid_ = std::move(grid.value());
+    graph.snapshot_file_ = std::move(file);
+
+    return graph;
+}
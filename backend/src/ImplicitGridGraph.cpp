@@ -0,0 +1,77 @@
+#include <Constants.hpp>
+#include <ImplicitGridGraph.hpp>
+#include <LatLng.hpp>
+#include <Range.hpp>
+#include <SphericalGrid.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+ImplicitGridGraph::ImplicitGridGraph(SphericalGrid&& grid) noexcept
+    : grid_(std::move(grid))
+{
+    row_cos_lats_.reserve(grid_.n_rows_);
+    row_sin_lats_.reserve(grid_.n_rows_);
+    for(auto m : utils::range(grid_.n_rows_)) {
+        const auto lat = Latitude<Degree>{Latitude<Radian>{grid_.calcTheta(m)}.toDegree() - 90};
+        row_cos_lats_.emplace_back(std::cos(lat.toRadian().getValue()));
+        row_sin_lats_.emplace_back(std::sin(lat.toRadian().getValue()));
+    }
+
+    grid_.lats_ = {};
+    grid_.lngs_ = {};
+    grid_.lats_view_ = {};
+    grid_.lngs_view_ = {};
+}
+
+auto ImplicitGridGraph::size() const noexcept
+    -> std::size_t
+{
+    return grid_.size();
+}
+
+auto ImplicitGridGraph::isLandNode(NodeId node) const noexcept
+    -> bool
+{
+    return grid_.indexIsLand(node);
+}
+
+auto ImplicitGridGraph::nodeContracted(NodeId /* node */) const noexcept
+    -> bool
+{
+    return false;
+}
+
+std::vector<std::pair<NodeId, NodeId>> ImplicitGridGraph::randomSTPairs(uint amount) const noexcept
+{
+    std::vector<std::pair<NodeId, NodeId>> st_pairs;
+    while(st_pairs.size() < amount) {
+        auto source = rand() % size();
+        auto target = rand() % size();
+        if(grid_.indexIsWater(source) and grid_.indexIsWater(target)) {
+            st_pairs.emplace_back(source, target);
+        }
+    }
+    return st_pairs;
+}
+
+auto ImplicitGridGraph::idToRow(NodeId node) const noexcept
+    -> std::size_t
+{
+    const auto row_iter = std::upper_bound(std::cbegin(grid_.first_index_of_),
+                                           std::cend(grid_.first_index_of_),
+                                           node)
+        - 1;
+    return std::distance(std::cbegin(grid_.first_index_of_), row_iter);
+}
+
+auto ImplicitGridGraph::nodeVector(std::size_t m, std::size_t n) const noexcept
+    -> Vector3D
+{
+    const auto n_cols = grid_.first_index_of_[m + 1] - grid_.first_index_of_[m];
+    const auto phi = 2 * PI * n / n_cols;
+    const auto lng = Longitude<Degree>{Longitude<Radian>{phi}.toDegree() - 180}.toRadian().getValue();
+    return Vector3D{row_cos_lats_[m] * std::cos(lng),
+                    row_cos_lats_[m] * std::sin(lng),
+                    row_sin_lats_[m]};
+}
@@ -0,0 +1,157 @@
+#include <MappedFile.hpp>
+#include <algorithm>
+#include <array>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr auto FNV_OFFSET_BASIS = std::uint64_t{14695981039346656037ull};
+constexpr auto FNV_PRIME = std::uint64_t{1099511628211ull};
+constexpr auto ALIGNMENT = std::size_t{8};
+
+} // namespace
+
+MappedFile::MappedFile(const std::uint8_t* data, std::size_t size) noexcept
+    : data_(data),
+      size_(size) {}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_),
+      size_(other.size_)
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile::~MappedFile() noexcept
+{
+    if(data_ != nullptr) {
+        munmap(const_cast<std::uint8_t*>(data_), size_);
+    }
+}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept
+    -> MappedFile&
+{
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+}
+
+auto MappedFile::open(std::string_view path) noexcept
+    -> std::optional<MappedFile>
+{
+    const auto fd = ::open(std::string{path}.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return std::nullopt;
+    }
+
+    struct stat file_stats;
+    if(fstat(fd, &file_stats) != 0 or file_stats.st_size == 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    const auto size = static_cast<std::size_t>(file_stats.st_size);
+    auto* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    //the mapping stays valid after closing the descriptor
+    ::close(fd);
+
+    if(mapping == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    return MappedFile{static_cast<const std::uint8_t*>(mapping), size};
+}
+
+auto MappedFile::data() const noexcept
+    -> const std::uint8_t*
+{
+    return data_;
+}
+
+auto MappedFile::size() const noexcept
+    -> std::size_t
+{
+    return size_;
+}
+
+auto MappedFile::prefetch() const noexcept
+    -> void
+{
+    madvise(const_cast<std::uint8_t*>(data_), size_, MADV_WILLNEED);
+}
+
+auto MappedFile::checksum() const noexcept
+    -> std::uint64_t
+{
+    madvise(const_cast<std::uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+
+    //hash whole words, this is way faster than the bytewise
+    //FNV-1a and still good enough to detect a changed file
+    auto hash = FNV_OFFSET_BASIS;
+    const auto words = size_ / sizeof(std::uint64_t);
+    for(std::size_t i = 0; i < words; i++) {
+        std::uint64_t word;
+        std::memcpy(&word, data_ + i * sizeof(std::uint64_t), sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+
+    for(auto i = words * sizeof(std::uint64_t); i < size_; i++) {
+        hash = (hash ^ data_[i]) * FNV_PRIME;
+    }
+
+    return hash ^ size_;
+}
+
+
+BinaryWriter::BinaryWriter(const std::string& path)
+    : out_(path, std::ios::binary | std::ios::trunc) {}
+
+auto BinaryWriter::good() const noexcept
+    -> bool
+{
+    return out_.good();
+}
+
+auto BinaryWriter::close()
+    -> bool
+{
+    out_.close();
+    return !out_.fail();
+}
+
+auto BinaryWriter::pad()
+    -> void
+{
+    static constexpr std::array<char, ALIGNMENT> zeros{};
+    const auto padding = (ALIGNMENT - written_ % ALIGNMENT) % ALIGNMENT;
+    out_.write(zeros.data(), padding);
+    written_ += padding;
+}
+
+
+BinaryReader::BinaryReader(const MappedFile& file) noexcept
+    : file_(file) {}
+
+auto BinaryReader::skipPadding() noexcept
+    -> void
+{
+    position_ += (ALIGNMENT - position_ % ALIGNMENT) % ALIGNMENT;
+    position_ = std::min(position_, file_.size());
+}
+
+
+auto fileChecksum(std::string_view path) noexcept
+    -> std::optional<std::uint64_t>
+{
+    auto file = MappedFile::open(path);
+    if(!file) {
+        return std::nullopt;
+    }
+    return file->checksum();
+}
@@ -1,10 +1,106 @@
 #include <NodeLookup.hpp>
+#include <algorithm>
+#include <cmath>
+#include <execution>
 
 
+namespace {
+
+constexpr double COORDINATE_PRECISION = 1e7;
+
+auto toFixed(double value) noexcept
+    -> std::int32_t
+{
+    return static_cast<std::int32_t>(std::lround(value * COORDINATE_PRECISION));
+}
+
+auto fromFixed(std::int32_t value) noexcept
+    -> double
+{
+    return static_cast<double>(value) / COORDINATE_PRECISION;
+}
+
+} // namespace
+
 auto NodeLookup::addNode(std::uint64_t osmid,
                          double lon,
                          double lat) noexcept
     -> void
 {
-    nodes_.try_emplace(osmid, osmid, lon, lat);
+    unsorted_.push_back(Entry{osmid, toFixed(lon), toFixed(lat)});
+}
+
+auto NodeLookup::merge(NodeLookup&& other) noexcept
+    -> void
+{
+    if(unsorted_.empty()) {
+        unsorted_ = std::move(other.unsorted_);
+    } else {
+        unsorted_.insert(std::end(unsorted_),
+                         std::begin(other.unsorted_),
+                         std::end(other.unsorted_));
+    }
+    other.unsorted_.clear();
+    other.unsorted_.shrink_to_fit();
+}
+
+auto NodeLookup::finalize() noexcept
+    -> void
+{
+    // nodes which were finalized before are kept. like for the
+    // insertion of duplicates, the first node with an id wins
+    std::vector<Entry> entries;
+    entries.reserve(ids_.size() + unsorted_.size());
+    for(std::size_t i = 0; i < ids_.size(); i++) {
+        entries.push_back(Entry{ids_[i], lons_[i], lats_[i]});
+    }
+    entries.insert(std::end(entries),
+                   std::begin(unsorted_),
+                   std::end(unsorted_));
+    unsorted_.clear();
+    unsorted_.shrink_to_fit();
+
+    std::stable_sort(std::execution::par,
+                     std::begin(entries),
+                     std::end(entries),
+                     [](const auto& lhs, const auto& rhs) {
+                         return lhs.id < rhs.id;
+                     });
+
+    entries.erase(std::unique(std::begin(entries),
+                              std::end(entries),
+                              [](const auto& lhs, const auto& rhs) {
+                                  return lhs.id == rhs.id;
+                              }),
+                  std::end(entries));
+
+    ids_.resize(entries.size());
+    lons_.resize(entries.size());
+    lats_.resize(entries.size());
+    for(std::size_t i = 0; i < entries.size(); i++) {
+        ids_[i] = entries[i].id;
+        lons_[i] = entries[i].lon;
+        lats_[i] = entries[i].lat;
+    }
+
+    ids_.shrink_to_fit();
+    lons_.shrink_to_fit();
+    lats_.shrink_to_fit();
+}
+
+auto NodeLookup::findNode(std::uint64_t osmid) const noexcept
+    -> std::optional<OSMNode>
+{
+    const auto iter = std::lower_bound(std::begin(ids_),
+                                       std::end(ids_),
+                                       osmid);
+
+    if(iter == std::end(ids_) or *iter != osmid) {
+        return std::nullopt;
+    }
+
+    const auto idx = std::distance(std::begin(ids_), iter);
+    return OSMNode{osmid,
+                   fromFixed(lons_[idx]),
+                   fromFixed(lats_[idx])};
 }
@@ -6,6 +6,9 @@
 #include <osmpbfreader.h>
 #include <string_view>
 #include <LatLng.hpp>
+#include <algorithm>
+#include <iostream>
+#include <vector>
 
 
 
@@ -39,16 +42,108 @@ struct Visitor
     NodeLookup node_lookup_;
     CoastlineLookup coastline_lookup_;
 };
+
+// first pass of the two pass extraction, only collects the coastlines
+struct CoastlineVisitor
+{
+    void node_callback(uint64_t /* osmid */,
+                       double /* lon */,
+                       double /* lat */,
+                       const CanalTP::Tags& /* tags */) {}
+
+    void way_callback(uint64_t osmid,
+                      const CanalTP::Tags& tags,
+                      std::vector<uint64_t> refs)
+    {
+        if(auto iter = tags.find("natural");
+           iter != std::end(tags)
+           and iter->second == "coastline") {
+            coastline_lookup_.addCoastline(std::move(refs));
+        }
+    }
+
+    void relation_callback(uint64_t /* osmid */,
+                           const CanalTP::Tags& /* tags */,
+                           const CanalTP::References& /* refs */) {}
+
+    CoastlineLookup coastline_lookup_;
+};
+
+// second pass of the two pass extraction, only keeps the nodes
+// whose ids are contained in the sorted referenced_nodes_
+struct ReferencedNodeVisitor
+{
+    void node_callback(uint64_t osmid,
+                       double lon,
+                       double lat,
+                       const CanalTP::Tags& /*tags*/)
+    {
+        if(std::binary_search(std::begin(*referenced_nodes_),
+                              std::end(*referenced_nodes_),
+                              osmid)) {
+            node_lookup_.addNode(osmid, lon, lat);
+        }
+    }
+
+    void way_callback(uint64_t /* osmid */,
+                      const CanalTP::Tags& /* tags */,
+                      std::vector<uint64_t> /* refs */) {}
+
+    void relation_callback(uint64_t /* osmid */,
+                           const CanalTP::Tags& /* tags */,
+                           const CanalTP::References& /* refs */) {}
+
+    const std::vector<std::uint64_t>* referenced_nodes_;
+    NodeLookup node_lookup_;
+};
+
+auto parseCoastlineNodes(std::string_view path) noexcept
+    -> std::pair<NodeLookup, CoastlineLookup>
+{
+    CoastlineLookup coastline_lookup;
+    for(auto& v : CanalTP::read_osm_pbf_parallel<CoastlineVisitor>(path.data())) {
+        coastline_lookup.merge(std::move(v.coastline_lookup_));
+    }
+
+    const auto referenced_nodes = coastline_lookup.getReferencedNodes();
+    std::cout << "coastlines reference "
+              << referenced_nodes.size()
+              << " nodes" << std::endl;
+
+    const auto exemplar = ReferencedNodeVisitor{&referenced_nodes, NodeLookup{}};
+
+    NodeLookup node_lookup;
+    for(auto& v : CanalTP::read_osm_pbf_parallel(path.data(), exemplar)) {
+        node_lookup.merge(std::move(v.node_lookup_));
+    }
+
+    return std::pair{std::move(node_lookup),
+                     std::move(coastline_lookup)};
+}
+
 } // namespace
 
 
 
-auto parsePBFFile(std::string_view path) noexcept
+auto parsePBFFile(std::string_view path,
+                  bool only_coastline_nodes) noexcept
     -> std::pair<NodeLookup, CoastlineLookup>
 {
-    Visitor v;
-    CanalTP::read_osm_pbf(path.data(), v);
+    if(only_coastline_nodes) {
+        return parseCoastlineNodes(path);
+    }
+
+    // every thread parses its share of the blobs into its own visitor,
+    // the lookups of all threads are merged afterwards
+    auto visitors = CanalTP::read_osm_pbf_parallel<Visitor>(path.data());
+
+    NodeLookup node_lookup;
+    CoastlineLookup coastline_lookup;
+    for(auto& v : visitors) {
+        node_lookup.merge(std::move(v.node_lookup_));
+        coastline_lookup.merge(std::move(v.coastline_lookup_));
+    }
 
-    return std::pair{std::move(v.node_lookup_),
-                     std::move(v.coastline_lookup_)};
+    return std::pair{std::move(node_lookup),
+                     std::move(coastline_lookup)};
 }
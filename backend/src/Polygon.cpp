@@ -1,15 +1,23 @@
+#include <AngleSum.hpp>
 #include <CoastlineLookup.hpp>
 #include <Constants.hpp>
 #include <LatLng.hpp>
+#include <MappedFile.hpp>
 #include <NodeLookup.hpp>
 #include <OSMNode.hpp>
 #include <Polygon.hpp>
 #include <Range.hpp>
 #include <SphericalPoint.hpp>
 #include <Vector3D.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <execution>
 #include <fmt/core.h>
+#include <limits>
 #include <numeric>
+#include <optional>
+#include <tuple>
 
 
 namespace {
@@ -22,6 +30,55 @@ auto latLngTo3D(Latitude<Radian> lat, Longitude<Radian> lng) noexcept
                       std::sin(lat.getValue())};
 }
 
+// number of polygon edges crossing the meridian arc from p to the north pole,
+// which is outside of every coastline polygon. the plane of the meridian has
+// the normal (-my, mx, 0) for the horizontal direction (mx, my) of p. only the
+// edges with their points on different sides of it can cross the arc, for
+// them the crossing point is checked to lie north of p on the same meridian
+auto meridianCrossings(const double* x,
+                       const double* y,
+                       const double* z,
+                       std::size_t size,
+                       const Vector3D& p) noexcept
+    -> std::size_t
+{
+    // at the poles every meridian leads to the north pole, take the one of longitude 0
+    const auto horizontal = std::sqrt(p.getX() * p.getX() + p.getY() * p.getY());
+    const auto mx = horizontal > 0.0 ? p.getX() / horizontal : 1.0;
+    const auto my = horizontal > 0.0 ? p.getY() / horizontal : 0.0;
+
+    std::size_t crossings = 0;
+    auto previous_side = -my * x[size - 1] + mx * y[size - 1];
+    for(std::size_t i = 0; i < size; i++) {
+        const auto side = -my * x[i] + mx * y[i];
+        if((previous_side > 0) != (side > 0)) {
+            // crossing of the edge with the plane of the meridian
+            const auto previous = (i + size - 1) % size;
+            const auto t = previous_side / (previous_side - side);
+            const auto cx = x[previous] + t * (x[i] - x[previous]);
+            const auto cy = y[previous] + t * (y[i] - y[previous]);
+            const auto cz = z[previous] + t * (z[i] - z[previous]);
+
+            const auto on_meridian = cx * mx + cy * my > 0;
+            const auto north_of_p = cz > p.getZ() * std::sqrt(cx * cx + cy * cy + cz * cz);
+            if(on_meridian and north_of_p) {
+                crossings++;
+            }
+        }
+        previous_side = side;
+    }
+
+    return crossings;
+}
+
+// below this number of points summing up the angles
+// is cheaper than building and querying an edge index
+constexpr std::size_t EDGE_INDEX_MIN_POINTS = 64;
+
+// "SRPOLYGN"
+constexpr auto POLYGON_FILE_MAGIC = std::uint64_t{0x4e47594c4f505253ull};
+constexpr auto POLYGON_FILE_VERSION = std::uint32_t{3};
+
 } // namespace
 
 Polygon::Polygon(const std::vector<OSMNode>& nodes)
@@ -51,37 +108,118 @@ Polygon::Polygon(const std::vector<OSMNode>& nodes)
         x_.emplace_back(x / lenght);
         y_.emplace_back(y / lenght);
         z_.emplace_back(z / lenght);
-        points_.emplace_back(lat, lng);
+    }
+
+    auto wraps_antimeridian = false;
+    for(std::size_t i = 0; i < nodes.size(); i++) {
+        const auto lng = nodes[i].getLon().getValue();
+        const auto next_lng = nodes[(i + 1) % nodes.size()].getLon().getValue();
+        wraps_antimeridian = wraps_antimeridian or std::abs(next_lng - lng) > 180.0;
+    }
+
+    if(!wraps_antimeridian) {
+        bounding_boxes_.emplace_back(BoundingBox{bottom_, top_, left_, right_});
+    } else {
+        auto west_right = Longitude<Degree>{-180.0};
+        auto east_left = Longitude<Degree>{180.0};
+        for(const auto& n : nodes) {
+            if(n.getLon() < 0.0) {
+                west_right = std::max(west_right, n.getLon());
+            } else {
+                east_left = std::min(east_left, n.getLon());
+            }
+        }
+
+        bounding_boxes_.emplace_back(BoundingBox{bottom_, top_, Longitude<Degree>{-180.0}, west_right});
+        bounding_boxes_.emplace_back(BoundingBox{bottom_, top_, east_left, Longitude<Degree>{180.0}});
+    }
+
+    buildEdgeIndex();
+}
+
+Polygon::Polygon(std::vector<double>&& x,
+                 std::vector<double>&& y,
+                 std::vector<double>&& z,
+                 BoundingBox extent,
+                 std::vector<BoundingBox>&& bounding_boxes)
+    : x_(std::move(x)),
+      y_(std::move(y)),
+      z_(std::move(z)),
+      top_(extent.top),
+      left_(extent.left),
+      bottom_(extent.bottom),
+      right_(extent.right),
+      bounding_boxes_(std::move(bounding_boxes))
+{
+    buildEdgeIndex();
+}
+
+auto Polygon::buildEdgeIndex() noexcept
+    -> void
+{
+    if(numberOfPoints() >= EDGE_INDEX_MIN_POINTS) {
+        edge_index_ = PolygonEdgeIndex::build(x_.data(),
+                                              y_.data(),
+                                              z_.data(),
+                                              numberOfPoints());
     }
 }
 
+auto Polygon::getBoundingBoxes() const noexcept
+    -> const std::vector<BoundingBox>&
+{
+    return bounding_boxes_;
+}
+
 auto Polygon::pointInRectangle(Latitude<Degree> lat, Longitude<Degree> lng) const -> bool
 {
-    return bottom_ <= lat and lat <= top_ and left_ <= lng and lng <= right_;
+    return std::any_of(std::cbegin(bounding_boxes_),
+                       std::cend(bounding_boxes_),
+                       [&](const auto& box) {
+                           return box.contains(lat, lng);
+                       });
 }
 
-auto Polygon::pointInPolygon(Latitude<Degree> lat, Longitude<Degree> lng, const Vector3D& p) const
+auto Polygon::pointInPolygon(Latitude<Degree> lat,
+                             Longitude<Degree> lng,
+                             const Vector3D& p,
+                             ContainmentTest test) const
     -> bool
 {
     if(!pointInRectangle(lat, lng)) {
         return false;
     }
-    const auto size = numberOfPoints();
-    const auto range = utils::range(size);
-
-    auto sum = std::transform_reduce(
-        std::execution::unseq,
-        std::begin(range),
-        std::end(range),
-        0.0,
-        [&](auto current, auto next) {
-            return current + next;
-        },
-        [&](auto idx) {
-            const auto first = p - points_[idx % size];
-            const auto second = p - points_[(idx + 1) % size];
-            return first.angleBetween(second, p);
-        });
+
+    if(edge_index_ and test == ContainmentTest::EDGE_INDEX) {
+        return edge_index_->contains(lat.getValue(),
+                                     lng.getValue(),
+                                     x_.data(),
+                                     y_.data(),
+                                     z_.data(),
+                                     numberOfPoints());
+    }
+
+    return containsPoint(p, test);
+}
+
+auto Polygon::containsPoint(const Vector3D& p, ContainmentTest test) const
+    -> bool
+{
+    if(test == ContainmentTest::RAY_CASTING) {
+        return meridianCrossings(x_.data(),
+                                 y_.data(),
+                                 z_.data(),
+                                 numberOfPoints(),
+                                 p)
+            % 2
+            == 1;
+    }
+
+    const auto sum = angleSum(x_.data(),
+                              y_.data(),
+                              z_.data(),
+                              numberOfPoints(),
+                              p);
 
 
     // external points should sum up to something close to 0
@@ -122,54 +260,496 @@ auto Polygon::getLatAndLng() const
     return ret_vec;
 }
 
+auto Polygon::hash() const noexcept
+    -> std::uint64_t
+{
+    constexpr auto FNV_OFFSET_BASIS = std::uint64_t{14695981039346656037ull};
+    constexpr auto FNV_PRIME = std::uint64_t{1099511628211ull};
+
+    auto hash = FNV_OFFSET_BASIS;
+    for(const auto* coordinates : {&x_, &y_, &z_}) {
+        for(auto value : *coordinates) {
+            std::uint64_t word;
+            std::memcpy(&word, &value, sizeof(word));
+            hash = (hash ^ word) * FNV_PRIME;
+        }
+    }
+
+    return hash ^ numberOfPoints();
+}
+
 auto Polygon::numberOfPoints() const
     -> std::size_t
 {
     return x_.size();
 }
 
+namespace {
+
+// links coastline ways, sorted by their first node, into rings. every way is
+// followed by the way starting at its last node. returns the indices of the
+// ways forming each ring in order. open chains start at the way without a
+// predecessor, the remaining ways form closed cycles
+auto assembleRings(const std::vector<std::vector<std::uint64_t>>& ways) noexcept
+    -> std::vector<std::vector<std::size_t>>
+{
+    constexpr auto NONE = std::numeric_limits<std::size_t>::max();
+
+    // endpoint index, the first node of every way
+    std::vector<std::uint64_t> firsts(ways.size());
+    std::transform(std::begin(ways),
+                   std::end(ways),
+                   std::begin(firsts),
+                   [](const auto& way) {
+                       return way.front();
+                   });
+
+    std::vector<std::size_t> next(ways.size());
+    std::transform(std::execution::par,
+                   std::begin(ways),
+                   std::end(ways),
+                   std::begin(next),
+                   [&](const auto& way) {
+                       if(way.front() == way.back()) {
+                           return NONE;
+                       }
+
+                       auto iter = std::lower_bound(std::begin(firsts),
+                                                    std::end(firsts),
+                                                    way.back());
+                       if(iter == std::end(firsts) or *iter != way.back()) {
+                           return NONE;
+                       }
+                       return static_cast<std::size_t>(
+                           std::distance(std::begin(firsts), iter));
+                   });
+
+    std::vector<bool> has_predecessor(ways.size(), false);
+    for(auto n : next) {
+        if(n != NONE) {
+            has_predecessor[n] = true;
+        }
+    }
+
+    std::vector<bool> visited(ways.size(), false);
+    std::vector<std::vector<std::size_t>> rings;
+    const auto follow = [&](std::size_t way) {
+        std::vector<std::size_t> ring;
+        while(way != NONE and !visited[way]) {
+            visited[way] = true;
+            ring.emplace_back(way);
+            way = next[way];
+        }
+        rings.emplace_back(std::move(ring));
+    };
+
+    for(std::size_t way = 0; way < ways.size(); way++) {
+        if(!has_predecessor[way]) {
+            follow(way);
+        }
+    }
+    for(std::size_t way = 0; way < ways.size(); way++) {
+        if(!visited[way]) {
+            follow(way);
+        }
+    }
+
+    return rings;
+}
+
+} // namespace
+
 auto calculatePolygons(CoastlineLookup&& coastline_lookup,
                        NodeLookup&& node_lookup) noexcept
     -> std::vector<Polygon>
 {
     auto coastlines = std::move(coastline_lookup.coastlines_);
+    node_lookup.finalize();
+
+    std::vector<std::vector<std::uint64_t>> ways;
+    ways.reserve(coastlines.size());
+    for(auto& [_, coastline] : coastlines) {
+        ways.emplace_back(std::move(coastline.getRefs()));
+    }
+    coastlines.clear();
+
+    std::sort(std::execution::par,
+              std::begin(ways),
+              std::end(ways),
+              [](const auto& lhs, const auto& rhs) {
+                  return lhs.front() < rhs.front();
+              });
+
+    const auto rings = assembleRings(ways);
+
+    std::atomic_size_t missing_nodes = 0;
+    std::vector<std::optional<Polygon>> ring_polygons(rings.size());
+    std::transform(std::execution::par,
+                   std::begin(rings),
+                   std::end(rings),
+                   std::begin(ring_polygons),
+                   [&](const auto& ring) -> std::optional<Polygon> {
+                       std::vector<OSMNode> polygon_nodes;
+                       const auto add_node = [&](auto id) {
+                           if(auto node = node_lookup.findNode(id)) {
+                               polygon_nodes.emplace_back(node.value());
+                           } else {
+                               missing_nodes++;
+                           }
+                       };
+
+                       // the first node of every following way is the last node of its predecessor
+                       for(auto way : ring) {
+                           const auto& refs = ways[way];
+                           const auto skip = way == ring.front() ? 0 : 1;
+                           std::for_each(std::begin(refs) + skip,
+                                         std::end(refs),
+                                         add_node);
+                       }
+
+                       // open chains are closed with their first node
+                       const auto ring_first = ways[ring.front()].front();
+                       const auto ring_last = ways[ring.back()].back();
+                       if(ring_first != ring_last) {
+                           add_node(ring_first);
+                       }
+
+                       if(polygon_nodes.empty()) {
+                           return std::nullopt;
+                       }
+                       return Polygon{polygon_nodes};
+                   });
 
     std::vector<Polygon> polygons;
-    while(!coastlines.empty()) {
-        auto [first, current_line] = std::move(*coastlines.begin());
+    polygons.reserve(ring_polygons.size());
+    for(auto& polygon : ring_polygons) {
+        if(polygon) {
+            polygons.emplace_back(std::move(polygon.value()));
+        }
+    }
+
+    if(missing_nodes > 0) {
+        fmt::print("{} nodes referenced by coastlines were not found\n", missing_nodes.load());
+    }
+
+    return polygons;
+}
+
+auto savePolygons(const std::string& path,
+                  std::uint64_t data_checksum,
+                  const std::vector<Polygon>& polygons) noexcept
+    -> bool
+{
+    // the arrays of all polygons are concatenated, polygon i owns the
+    // points [point_offsets[i], point_offsets[i + 1]) and the boxes
+    // [box_offsets[i], box_offsets[i + 1]) of them
+    std::vector<std::uint64_t> point_offsets{0};
+    std::vector<std::uint64_t> box_offsets{0};
+    std::vector<BoundingBox> extents;
+    std::vector<BoundingBox> boxes;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+
+    for(const auto& polygon : polygons) {
+        x.insert(std::end(x), std::cbegin(polygon.x_), std::cend(polygon.x_));
+        y.insert(std::end(y), std::cbegin(polygon.y_), std::cend(polygon.y_));
+        z.insert(std::end(z), std::cbegin(polygon.z_), std::cend(polygon.z_));
+        point_offsets.emplace_back(x.size());
+
+        extents.emplace_back(BoundingBox{polygon.bottom_, polygon.top_, polygon.left_, polygon.right_});
+        boxes.insert(std::end(boxes),
+                     std::cbegin(polygon.bounding_boxes_),
+                     std::cend(polygon.bounding_boxes_));
+        box_offsets.emplace_back(boxes.size());
+    }
+
+    return writeFileAtomically(path, [&](BinaryWriter& writer) {
+        writer.write(POLYGON_FILE_MAGIC);
+        writer.write(POLYGON_FILE_VERSION);
+        writer.write(data_checksum);
+        writer.writeArray(point_offsets);
+        writer.writeArray(box_offsets);
+        writer.writeArray(extents);
+        writer.writeArray(boxes);
+        writer.writeArray(x);
+        writer.writeArray(y);
+        writer.writeArray(z);
+        return writer.good();
+    });
+}
 
-        while(current_line.getRefs().front() != current_line.getRefs().back()) {
-            auto current_last = current_line.getRefs().back();
+auto loadPolygons(std::string_view path,
+                  std::uint64_t data_checksum) noexcept
+    -> std::optional<std::vector<Polygon>>
+{
+    auto file = MappedFile::open(path);
+    if(!file) {
+        return std::nullopt;
+    }
+
+    BinaryReader reader{file.value()};
+    const auto magic = reader.read<std::uint64_t>();
+    const auto version = reader.read<std::uint32_t>();
+    const auto checksum = reader.read<std::uint64_t>();
+    if(magic != POLYGON_FILE_MAGIC
+       or version != POLYGON_FILE_VERSION
+       or checksum != data_checksum) {
+        return std::nullopt;
+    }
+
+    const auto point_offsets = reader.readArray<std::uint64_t>();
+    const auto box_offsets = reader.readArray<std::uint64_t>();
+    const auto extents = reader.readArray<BoundingBox>();
+    const auto boxes = reader.readArray<BoundingBox>();
+    const auto x = reader.readArray<double>();
+    const auto y = reader.readArray<double>();
+    const auto z = reader.readArray<double>();
+    if(!point_offsets or !box_offsets or !extents or !boxes
+       or !x or !y or !z) {
+        return std::nullopt;
+    }
+
+    const auto number_of_polygons = extents->size();
+    const auto number_of_points = x->size();
+    if(point_offsets->size() != number_of_polygons + 1
+       or box_offsets->size() != number_of_polygons + 1
+       or (*point_offsets)[number_of_polygons] != number_of_points
+       or (*box_offsets)[number_of_polygons] != boxes->size()
+       or y->size() != number_of_points
+       or z->size() != number_of_points
+       or !std::is_sorted(std::cbegin(point_offsets.value()), std::cend(point_offsets.value()))
+       or !std::is_sorted(std::cbegin(box_offsets.value()), std::cend(box_offsets.value()))) {
+        return std::nullopt;
+    }
+
+    const auto copy = [](const auto& array, std::uint64_t begin, std::uint64_t end) {
+        return std::vector<std::decay_t<decltype(array[0])>>(std::begin(array) + begin,
+                                                             std::begin(array) + end);
+    };
+
+    // the edge indices are rebuilt, which is cheap compared to parsing the data file
+    std::vector<std::optional<Polygon>> loaded(number_of_polygons);
+    const auto range = utils::range(number_of_polygons);
+    std::transform(std::execution::par,
+                   std::cbegin(range),
+                   std::cend(range),
+                   std::begin(loaded),
+                   [&](auto idx) -> std::optional<Polygon> {
+                       const auto first = point_offsets.value()[idx];
+                       const auto last = point_offsets.value()[idx + 1];
+                       if(first == last) {
+                           return std::nullopt;
+                       }
 
-            auto iter = coastlines.find(current_last);
-            if(iter == std::end(coastlines)) {
-                current_line.getRefs().emplace_back(current_line.getRefs().front());
-                continue;
+                       return Polygon{copy(x.value(), first, last),
+                                      copy(y.value(), first, last),
+                                      copy(z.value(), first, last),
+                                      extents.value()[idx],
+                                      copy(boxes.value(), box_offsets.value()[idx], box_offsets.value()[idx + 1])};
+                   });
+
+    if(std::any_of(std::cbegin(loaded),
+                   std::cend(loaded),
+                   [](const auto& polygon) { return !polygon.has_value(); })) {
+        return std::nullopt;
+    }
+
+    std::vector<Polygon> polygons;
+    polygons.reserve(number_of_polygons);
+    for(auto& polygon : loaded) {
+        polygons.emplace_back(std::move(polygon.value()));
+    }
+
+    return polygons;
+}
+
+auto polygonFileChecksum(std::string_view path) noexcept
+    -> std::optional<std::uint64_t>
+{
+    auto file = MappedFile::open(path);
+    if(!file) {
+        return std::nullopt;
+    }
+
+    BinaryReader reader{file.value()};
+    if(reader.read<std::uint64_t>() != POLYGON_FILE_MAGIC
+       or reader.read<std::uint32_t>() != POLYGON_FILE_VERSION) {
+        return std::nullopt;
+    }
+
+    return reader.read<std::uint64_t>();
+}
+
+namespace {
+
+// an edge of a ring with its endpoints in ascending order, such
+// that an edge is equal to itself in the opposite direction
+struct RingEdge
+{
+    std::pair<double, double> from;
+    std::pair<double, double> to;
+    bool is_new;
+};
+
+// the box around a connected part of the changed edges. the region enclosed by them
+// only leaves its extent if an edge crosses the antimeridian: an even number of
+// crossings splits it into a box at each side, an odd number encircles a pole
+auto boxesAround(const std::vector<RingEdge>& edges,
+                 const std::vector<std::size_t>& part,
+                 std::vector<BoundingBox>& boxes) noexcept
+    -> void
+{
+    auto bottom = 90.0;
+    auto top = -90.0;
+    auto left = 180.0;
+    auto right = -180.0;
+    auto west_right = -180.0;
+    auto east_left = 180.0;
+    std::size_t antimeridian_crossings = 0;
+    for(auto idx : part) {
+        const auto& edge = edges[idx];
+        for(const auto& [lat, lng] : {edge.from, edge.to}) {
+            bottom = std::min(bottom, lat);
+            top = std::max(top, lat);
+            left = std::min(left, lng);
+            right = std::max(right, lng);
+            if(lng < 0.0) {
+                west_right = std::max(west_right, lng);
+            } else {
+                east_left = std::min(east_left, lng);
             }
+        }
+        antimeridian_crossings += std::abs(edge.to.second - edge.from.second) > 180.0;
+    }
 
-            auto [inner_first, append_line] = std::move(*iter);
-            coastlines.erase(current_last);
+    if(antimeridian_crossings % 2 == 1) {
+        boxes.emplace_back(BoundingBox{Latitude<Degree>{top < 0.0 ? -90.0 : bottom},
+                                       Latitude<Degree>{top < 0.0 ? top : 90.0},
+                                       Longitude<Degree>{-180.0},
+                                       Longitude<Degree>{180.0}});
+    } else if(antimeridian_crossings > 0) {
+        boxes.emplace_back(BoundingBox{Latitude<Degree>{bottom},
+                                       Latitude<Degree>{top},
+                                       Longitude<Degree>{-180.0},
+                                       Longitude<Degree>{west_right}});
+        boxes.emplace_back(BoundingBox{Latitude<Degree>{bottom},
+                                       Latitude<Degree>{top},
+                                       Longitude<Degree>{east_left},
+                                       Longitude<Degree>{180.0}});
+    } else {
+        boxes.emplace_back(BoundingBox{Latitude<Degree>{bottom},
+                                       Latitude<Degree>{top},
+                                       Longitude<Degree>{left},
+                                       Longitude<Degree>{right}});
+    }
+}
 
-            auto new_nodes = std::move(current_line.getRefs());
-            std::copy(std::begin(append_line.getRefs()) + 1,
-                      std::end(append_line.getRefs()),
-                      std::back_inserter(new_nodes));
+} // namespace
 
-            current_line = std::move(new_nodes);
+auto changedBoundingBoxes(const std::vector<Polygon>& old_polygons,
+                          const std::vector<Polygon>& new_polygons) noexcept
+    -> std::vector<BoundingBox>
+{
+    const auto hashes = [](const std::vector<Polygon>& polygons) {
+        std::vector<std::uint64_t> hashes(polygons.size());
+        std::transform(std::execution::par,
+                       std::cbegin(polygons),
+                       std::cend(polygons),
+                       std::begin(hashes),
+                       [](const auto& polygon) { return polygon.hash(); });
+        return hashes;
+    };
+
+    const auto old_hashes = hashes(old_polygons);
+    const auto new_hashes = hashes(new_polygons);
+
+    auto old_sorted = old_hashes;
+    auto new_sorted = new_hashes;
+    std::sort(std::execution::par, std::begin(old_sorted), std::end(old_sorted));
+    std::sort(std::execution::par, std::begin(new_sorted), std::end(new_sorted));
+
+    // rings of one set missing in the other set were either removed, added or changed
+    std::vector<RingEdge> edges;
+    const auto collect = [&](const std::vector<Polygon>& polygons,
+                             const std::vector<std::uint64_t>& polygon_hashes,
+                             const std::vector<std::uint64_t>& other_sorted,
+                             bool is_new) {
+        for(std::size_t i = 0; i < polygons.size(); i++) {
+            if(!std::binary_search(std::cbegin(other_sorted),
+                                   std::cend(other_sorted),
+                                   polygon_hashes[i])) {
+                const auto points = polygons[i].getLatAndLng();
+                for(std::size_t j = 0; j < points.size(); j++) {
+                    const auto [from, to] = std::minmax(points[j], points[(j + 1) % points.size()]);
+                    edges.emplace_back(RingEdge{from, to, is_new});
+                }
+            }
         }
+    };
 
-        coastlines.erase(first);
+    collect(old_polygons, old_hashes, new_sorted, false);
+    collect(new_polygons, new_hashes, old_sorted, true);
 
-        std::vector<OSMNode> polygon_nodes;
-        std::transform(std::begin(current_line.getRefs()),
-                       std::end(current_line.getRefs()),
-                       std::back_inserter(polygon_nodes),
-                       [&](auto id) {
-                           return std::move(node_lookup.nodes_.find(id)->second);
-                       });
+    // a changed ring mostly keeps its edges. edges in both sets cancel out, such
+    // that only the edges which were removed or added are left
+    std::sort(std::execution::par,
+              std::begin(edges),
+              std::end(edges),
+              [](const auto& lhs, const auto& rhs) {
+                  return std::tie(lhs.from, lhs.to, lhs.is_new) < std::tie(rhs.from, rhs.to, rhs.is_new);
+              });
+    std::vector<RingEdge> changed_edges;
+    for(auto first = std::cbegin(edges); first != std::cend(edges);) {
+        const auto last = std::find_if(first, std::cend(edges), [&](const auto& edge) {
+            return edge.from != first->from or edge.to != first->to;
+        });
+        const auto added = std::count_if(first, last, [](const auto& edge) { return edge.is_new; });
+        const auto removed = std::distance(first, last) - added;
+        for(auto i = std::min(added, removed); i < std::max(added, removed); i++) {
+            changed_edges.emplace_back(*first);
+        }
+        first = last;
+    }
+    edges = {};
+
+    // both sets of rings are closed, so are the changed edges. a node only changes
+    // between land and water if it is enclosed by them, the changed edges are joined
+    // at their shared points into connected parts, every part gets its own box
+    std::vector<std::size_t> parent(changed_edges.size());
+    std::iota(std::begin(parent), std::end(parent), std::size_t{0});
+    const auto find = [&](std::size_t idx) {
+        while(parent[idx] != idx) {
+            parent[idx] = parent[parent[idx]];
+            idx = parent[idx];
+        }
+        return idx;
+    };
 
-        polygons.emplace_back(std::move(polygon_nodes));
+    std::vector<std::pair<std::pair<double, double>, std::size_t>> endpoints;
+    endpoints.reserve(2 * changed_edges.size());
+    for(std::size_t i = 0; i < changed_edges.size(); i++) {
+        endpoints.emplace_back(changed_edges[i].from, i);
+        endpoints.emplace_back(changed_edges[i].to, i);
+    }
+    std::sort(std::execution::par, std::begin(endpoints), std::end(endpoints));
+    for(std::size_t i = 1; i < endpoints.size(); i++) {
+        if(endpoints[i].first == endpoints[i - 1].first) {
+            parent[find(endpoints[i].second)] = find(endpoints[i - 1].second);
+        }
     }
 
-    return polygons;
+    std::vector<std::vector<std::size_t>> parts(changed_edges.size());
+    for(std::size_t i = 0; i < changed_edges.size(); i++) {
+        parts[find(i)].emplace_back(i);
+    }
+
+    std::vector<BoundingBox> boxes;
+    for(const auto& part : parts) {
+        if(!part.empty()) {
+            boxesAround(changed_edges, part, boxes);
+        }
+    }
+
+    return boxes;
 }
@@ -0,0 +1,222 @@
+#include <Constants.hpp>
+#include <PolygonEdgeIndex.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+
+namespace {
+
+// the index has roughly one cell per edge, most of them
+// empty as the edges are concentrated along the coast
+constexpr std::size_t MAX_CELLS_PER_DIMENSION = 4096;
+
+auto clampCell(double value, std::size_t size) noexcept
+    -> std::size_t
+{
+    if(value <= 0) {
+        return 0;
+    }
+    return std::min(static_cast<std::size_t>(value), size - 1);
+}
+
+// latitude and longitude in degrees of a unit vector, computed
+// the same way as by Polygon::getLatAndLng
+auto latOf(double x, double y, double z) noexcept
+    -> double
+{
+    return std::atan2(z, std::sqrt(x * x + y * y)) * 180 / PI;
+}
+
+auto lngOf(double x, double y) noexcept
+    -> double
+{
+    return std::atan2(y, x) * 180 / PI;
+}
+
+} // namespace
+
+auto PolygonEdgeIndex::build(const double* x,
+                             const double* y,
+                             const double* z,
+                             std::size_t size) noexcept
+    -> std::optional<PolygonEdgeIndex>
+{
+    if(size < 2
+       or size >= std::numeric_limits<std::uint32_t>::max()) {
+        return std::nullopt;
+    }
+
+    // only needed while building, the tests compute the few coordinates they need
+    std::vector<double> lats(size);
+    std::vector<double> lngs(size);
+    for(std::size_t i = 0; i < size; i++) {
+        lats[i] = latOf(x[i], y[i], z[i]);
+        lngs[i] = lngOf(x[i], y[i]);
+    }
+
+    // edge i connects the points i and i + 1, the edge from the last point
+    // to the first one closes the ring if it is not already closed
+    const auto closed = x[0] == x[size - 1] and y[0] == y[size - 1] and z[0] == z[size - 1];
+    const auto number_of_edges = closed ? size - 1 : size;
+    const auto next = [&](std::size_t edge) {
+        return (edge + 1) % size;
+    };
+
+    for(std::size_t edge = 0; edge < number_of_edges; edge++) {
+        if(std::abs(lngs[next(edge)] - lngs[edge]) > 180.0) {
+            return std::nullopt;
+        }
+    }
+
+    PolygonEdgeIndex index;
+    const auto [min_lat, max_lat] = std::minmax_element(std::begin(lats), std::end(lats));
+    const auto [min_lng, max_lng] = std::minmax_element(std::begin(lngs), std::end(lngs));
+
+    const auto height = std::max(*max_lat - *min_lat, 1e-9);
+    const auto width = std::max(*max_lng - *min_lng, 1e-9);
+    const auto columns = std::clamp(std::ceil(std::sqrt(number_of_edges * width / height)),
+                                    1.0,
+                                    static_cast<double>(MAX_CELLS_PER_DIMENSION));
+    const auto rows = std::clamp(std::ceil(number_of_edges / columns),
+                                 1.0,
+                                 static_cast<double>(MAX_CELLS_PER_DIMENSION));
+
+    index.bottom_ = *min_lat;
+    index.left_ = *min_lng;
+    index.rows_ = static_cast<std::size_t>(rows);
+    index.columns_ = static_cast<std::size_t>(columns);
+    index.cell_height_ = height / rows;
+    index.cell_width_ = width / columns;
+
+    // counting sort of the edges into the cells they intersect,
+    // approximated by the bounding box of every edge
+    const auto number_of_cells = index.rows_ * index.columns_;
+    std::vector<std::uint32_t> cell_sizes(number_of_cells + 1, 0);
+
+    const auto for_each_edge_cell = [&](std::size_t edge, auto&& callback) {
+        const auto [first_row, first_column] = index.cellOf(std::min(lats[edge], lats[next(edge)]),
+                                                            std::min(lngs[edge], lngs[next(edge)]));
+        const auto [last_row, last_column] = index.cellOf(std::max(lats[edge], lats[next(edge)]),
+                                                          std::max(lngs[edge], lngs[next(edge)]));
+        for(auto row = first_row; row <= last_row; row++) {
+            for(auto column = first_column; column <= last_column; column++) {
+                callback(row * index.columns_ + column);
+            }
+        }
+    };
+
+    for(std::size_t edge = 0; edge < number_of_edges; edge++) {
+        for_each_edge_cell(edge, [&](auto cell) {
+            cell_sizes[cell + 1]++;
+        });
+    }
+
+    std::partial_sum(std::begin(cell_sizes),
+                     std::end(cell_sizes),
+                     std::begin(cell_sizes));
+    index.cell_offsets_ = cell_sizes;
+    index.cell_edges_.resize(cell_sizes.back());
+
+    for(std::size_t edge = 0; edge < number_of_edges; edge++) {
+        for_each_edge_cell(edge, [&](auto cell) {
+            index.cell_edges_[cell_sizes[cell]++] = static_cast<std::uint32_t>(edge);
+        });
+    }
+
+    // crossings of the edges with the latitude of every row center
+    std::vector<std::pair<std::uint32_t, double>> crossings;
+    for(std::size_t edge = 0; edge < number_of_edges; edge++) {
+        const auto lat_from = lats[edge];
+        const auto lat_to = lats[next(edge)];
+        const auto lng_from = lngs[edge];
+        const auto lng_to = lngs[next(edge)];
+
+        const auto [first_row, _] = index.cellOf(std::min(lat_from, lat_to), index.left_);
+        const auto [last_row, __] = index.cellOf(std::max(lat_from, lat_to), index.left_);
+
+        for(auto row = first_row; row <= last_row; row++) {
+            const auto center = index.bottom_ + (row + 0.5) * index.cell_height_;
+            if((lat_from > center) != (lat_to > center)) {
+                const auto lng = lng_from + (center - lat_from) * (lng_to - lng_from) / (lat_to - lat_from);
+                crossings.emplace_back(static_cast<std::uint32_t>(row), lng);
+            }
+        }
+    }
+
+    std::sort(std::begin(crossings), std::end(crossings));
+
+    index.row_offsets_.assign(index.rows_ + 1, 0);
+    index.row_crossings_.reserve(crossings.size());
+    for(const auto& [row, lng] : crossings) {
+        index.row_offsets_[row + 1]++;
+        index.row_crossings_.emplace_back(lng);
+    }
+    std::partial_sum(std::begin(index.row_offsets_),
+                     std::end(index.row_offsets_),
+                     std::begin(index.row_offsets_));
+
+    return index;
+}
+
+auto PolygonEdgeIndex::cellOf(double lat, double lng) const noexcept
+    -> std::pair<std::size_t, std::size_t>
+{
+    return std::pair{clampCell((lat - bottom_) / cell_height_, rows_),
+                     clampCell((lng - left_) / cell_width_, columns_)};
+}
+
+auto PolygonEdgeIndex::contains(double lat,
+                                double lng,
+                                const double* x,
+                                const double* y,
+                                const double* z,
+                                std::size_t size) const noexcept
+    -> bool
+{
+    const auto [row, column] = cellOf(lat, lng);
+
+    // parity of (row center, lng), the number of crossings left of lng
+    const auto row_begin = std::begin(row_crossings_) + row_offsets_[row];
+    const auto row_end = std::begin(row_crossings_) + row_offsets_[row + 1];
+    const auto left_crossings = std::distance(row_begin, std::lower_bound(row_begin, row_end, lng));
+    auto inside = left_crossings % 2 == 1;
+
+    // move from the row center to lat, only the edges of this cell can be crossed
+    const auto center = bottom_ + (row + 0.5) * cell_height_;
+    const auto lower = std::min(center, lat);
+    const auto upper = std::max(center, lat);
+
+    // whether the point lies east of lng. the meridian of lng has the direction (mx, my)
+    // and the plane through it the normal (-my, mx), the side of the plane is the sign
+    // of the sine of the difference of the longitudes. it only agrees with comparing
+    // the longitudes for points less than 90 degrees away, the others compare them
+    const auto mx = std::cos(lng * PI / 180);
+    const auto my = std::sin(lng * PI / 180);
+    const auto eastOf = [&](std::size_t point) {
+        if(x[point] * mx + y[point] * my >= 0) {
+            return -my * x[point] + mx * y[point] > 0;
+        }
+        return lngOf(x[point], y[point]) > lng;
+    };
+
+    const auto cell = row * columns_ + column;
+    for(auto i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; i++) {
+        const auto from = cell_edges_[i];
+        const auto to = (from + 1) % size;
+
+        if(eastOf(from) != eastOf(to)) {
+            const auto lat_from = latOf(x[from], y[from], z[from]);
+            const auto lat_to = latOf(x[to], y[to], z[to]);
+            const auto lng_from = lngOf(x[from], y[from]);
+            const auto lng_to = lngOf(x[to], y[to]);
+            const auto crossing = lat_from + (lng - lng_from) * (lat_to - lat_from) / (lng_to - lng_from);
+            if(lower < crossing and crossing <= upper) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
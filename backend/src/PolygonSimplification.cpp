@@ -0,0 +1,463 @@
+#include <Constants.hpp>
+#include <PolygonSimplification.hpp>
+#include <Range.hpp>
+#include <Vector3D.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+
+
+namespace {
+
+// the segment index has roughly one cell per segment
+// of all rings, most of them empty on the open sea
+constexpr std::size_t MAX_CELLS_PER_DIMENSION = 2048;
+
+// distance in meters from p to the closest point of the great circle arc from a to b
+auto distanceToArc(const Vector3D& p, const Vector3D& a, const Vector3D& b) noexcept
+    -> double
+{
+    const auto normal = a.crossProduct(b);
+    const auto normal_length = normal.length();
+    if(normal_length == 0.0) {
+        return p.distanceTo(a);
+    }
+
+    // the projection of p onto the great circle lies between a and b
+    if(a.crossProduct(p).dotProduct(normal) >= 0.0
+       and p.crossProduct(b).dotProduct(normal) >= 0.0) {
+        const auto sin_distance = std::abs(normal.dotProduct(p)) / normal_length;
+        return std::asin(std::min(1.0, sin_distance)) * EARTH_RADIUS_IN_METERS;
+    }
+
+    return std::min(p.distanceTo(a), p.distanceTo(b));
+}
+
+// a ring during the simplification, closed implicitly without repeating its first
+// point at the end. the segments of the simplified ring connect the consecutive
+// kept points, where the index points.size() is the first point again
+struct Ring
+{
+    std::vector<std::pair<double, double>> lat_lngs;
+    std::vector<Vector3D> points;
+    std::vector<bool> keep;
+};
+
+// the point between first and last furthest away from the arc between them,
+// which is the first point between them if all of them lie on the arc
+auto splitPoint(const Ring& ring, std::size_t first, std::size_t last) noexcept
+    -> std::pair<std::size_t, double>
+{
+    const auto& a = ring.points[first];
+    const auto& b = ring.points[last % ring.points.size()];
+
+    auto max_distance = -1.0;
+    auto max_index = first;
+    for(auto i = first + 1; i < last; i++) {
+        const auto distance = distanceToArc(ring.points[i], a, b);
+        if(distance > max_distance) {
+            max_distance = distance;
+            max_index = i;
+        }
+    }
+    return std::pair{max_index, max_distance};
+}
+
+auto simplifyRing(Ring& ring, double tolerance) noexcept
+    -> void
+{
+    const auto& points = ring.points;
+    ring.keep.assign(points.size() + 1, false);
+
+    // the ring is split into two chains at the point furthest away from the first one
+    std::size_t furthest = 0;
+    auto furthest_distance = 0.0;
+    for(std::size_t i = 1; i < points.size(); i++) {
+        const auto distance = points[0].distanceTo(points[i]);
+        if(distance > furthest_distance) {
+            furthest_distance = distance;
+            furthest = i;
+        }
+    }
+
+    if(furthest == 0) {
+        ring.keep.assign(points.size() + 1, true);
+        return;
+    }
+
+    ring.keep[0] = true;
+    ring.keep[furthest] = true;
+    ring.keep[points.size()] = true;
+
+    std::vector<std::pair<std::size_t, std::size_t>> chains{{0, furthest},
+                                                            {furthest, points.size()}};
+    while(!chains.empty()) {
+        const auto [first, last] = chains.back();
+        chains.pop_back();
+
+        const auto [max_index, max_distance] = splitPoint(ring, first, last);
+        if(max_distance > tolerance) {
+            ring.keep[max_index] = true;
+            chains.emplace_back(first, max_index);
+            chains.emplace_back(max_index, last);
+        }
+    }
+
+    // rings which would collapse are kept as they are
+    if(std::count(std::cbegin(ring.keep), std::cend(ring.keep), true) < 4) {
+        ring.keep.assign(points.size() + 1, true);
+    }
+}
+
+// a segment of a simplified ring in the lat/lng plane, in which the
+// containment tests interpret the edges of the polygons
+struct Segment
+{
+    std::pair<double, double> from;
+    std::pair<double, double> to;
+    std::size_t ring;
+    std::size_t first;
+    std::size_t last;
+};
+
+auto orientation(const std::pair<double, double>& a,
+                 const std::pair<double, double>& b,
+                 const std::pair<double, double>& c) noexcept
+    -> double
+{
+    return (b.first - a.first) * (c.second - a.second)
+        - (b.second - a.second) * (c.first - a.first);
+}
+
+// a part of a segment which does not cross the antimeridian
+struct Part
+{
+    std::pair<double, double> from;
+    std::pair<double, double> to;
+};
+
+// calls `callback(part)` for the parts of the segment on either side of the
+// antimeridian. a segment across it is split at it, like the edges of the
+// polygons when the grid is filtered, instead of spanning the whole map
+template<class Callback>
+auto forEachPart(const Segment& segment, Callback&& callback) noexcept
+    -> void
+{
+    forEachAntimeridianPart(segment.from, segment.to, [&](auto from, auto to) {
+        callback(Part{from, to});
+    });
+}
+
+// whether p, which is collinear with the part, lies on it without being one of its ends
+auto touchesInterior(const Part& part, const std::pair<double, double>& p) noexcept
+    -> bool
+{
+    return p != part.from and p != part.to
+        and std::min(part.from.first, part.to.first) <= p.first
+        and p.first <= std::max(part.from.first, part.to.first)
+        and std::min(part.from.second, part.to.second) <= p.second
+        and p.second <= std::max(part.from.second, part.to.second);
+}
+
+// whether the parts cross or touch, parts which only share an end do not
+auto intersect(const Part& lhs, const Part& rhs) noexcept
+    -> bool
+{
+    const auto lhs_from = orientation(rhs.from, rhs.to, lhs.from);
+    const auto lhs_to = orientation(rhs.from, rhs.to, lhs.to);
+    const auto rhs_from = orientation(lhs.from, lhs.to, rhs.from);
+    const auto rhs_to = orientation(lhs.from, lhs.to, rhs.to);
+
+    if(((lhs_from > 0 and lhs_to < 0) or (lhs_from < 0 and lhs_to > 0))
+       and ((rhs_from > 0 and rhs_to < 0) or (rhs_from < 0 and rhs_to > 0))) {
+        return true;
+    }
+
+    return (lhs_from == 0 and touchesInterior(rhs, lhs.from))
+        or (lhs_to == 0 and touchesInterior(rhs, lhs.to))
+        or (rhs_from == 0 and touchesInterior(lhs, rhs.from))
+        or (rhs_to == 0 and touchesInterior(lhs, rhs.to));
+}
+
+// grid of cells over the bounding box of all segments, every cell stores
+// the segments of which the bounding box of a part intersects it
+class SegmentIndex
+{
+public:
+    explicit SegmentIndex(std::vector<Segment>&& segments) noexcept
+        : segments_(std::move(segments))
+    {
+        auto min_lat = 90.0;
+        auto max_lat = -90.0;
+        auto min_lng = 180.0;
+        auto max_lng = -180.0;
+        for(const auto& segment : segments_) {
+            forEachPart(segment, [&](const Part& part) {
+                for(const auto& [lat, lng] : {part.from, part.to}) {
+                    min_lat = std::min(min_lat, lat);
+                    max_lat = std::max(max_lat, lat);
+                    min_lng = std::min(min_lng, lng);
+                    max_lng = std::max(max_lng, lng);
+                }
+            });
+        }
+
+        const auto height = std::max(max_lat - min_lat, 1e-9);
+        const auto width = std::max(max_lng - min_lng, 1e-9);
+        const auto number_of_segments = static_cast<double>(std::max(segments_.size(), std::size_t{1}));
+
+        const auto columns = std::clamp(std::ceil(std::sqrt(number_of_segments * width / height)),
+                                        1.0,
+                                        static_cast<double>(MAX_CELLS_PER_DIMENSION));
+        const auto rows = std::clamp(std::ceil(number_of_segments / columns),
+                                     1.0,
+                                     static_cast<double>(MAX_CELLS_PER_DIMENSION));
+
+        bottom_ = min_lat;
+        left_ = min_lng;
+        rows_ = static_cast<std::size_t>(rows);
+        columns_ = static_cast<std::size_t>(columns);
+        cell_height_ = height / rows;
+        cell_width_ = width / columns;
+
+        // counting sort of the segments into the cells of their bounding boxes
+        cell_offsets_.assign(rows_ * columns_ + 1, 0);
+        for(const auto& segment : segments_) {
+            forEachCell(segment, [&](auto cell) {
+                cell_offsets_[cell + 1]++;
+            });
+        }
+
+        std::partial_sum(std::begin(cell_offsets_),
+                         std::end(cell_offsets_),
+                         std::begin(cell_offsets_));
+
+        auto cell_sizes = cell_offsets_;
+        cell_segments_.resize(cell_offsets_.back());
+        for(std::size_t i = 0; i < segments_.size(); i++) {
+            forEachCell(segments_[i], [&](auto cell) {
+                cell_segments_[cell_sizes[cell]++] = i;
+            });
+        }
+    }
+
+    // whether any other segment of the index intersects the given one
+    auto intersectsOther(const Segment& segment) const noexcept
+        -> bool
+    {
+        auto found = false;
+        forEachPart(segment, [&](const Part& part) {
+            forEachCell(part, [&](auto cell) {
+                for(auto i = cell_offsets_[cell]; !found and i < cell_offsets_[cell + 1]; i++) {
+                    const auto& other = segments_[cell_segments_[i]];
+                    if(other.ring == segment.ring and other.first == segment.first) {
+                        continue;
+                    }
+                    forEachPart(other, [&](const Part& other_part) {
+                        found = found or intersect(part, other_part);
+                    });
+                }
+            });
+        });
+        return found;
+    }
+
+    auto segments() const noexcept
+        -> const std::vector<Segment>&
+    {
+        return segments_;
+    }
+
+private:
+    // calls `callback(cell)` for the cells of the bounding boxes of all parts of the segment
+    template<class Callback>
+    auto forEachCell(const Segment& segment, Callback&& callback) const noexcept
+        -> void
+    {
+        forEachPart(segment, [&](const Part& part) {
+            forEachCell(part, callback);
+        });
+    }
+
+    template<class Callback>
+    auto forEachCell(const Part& part, Callback&& callback) const noexcept
+        -> void
+    {
+        const auto first_row = clampCell((std::min(part.from.first, part.to.first) - bottom_) / cell_height_, rows_);
+        const auto last_row = clampCell((std::max(part.from.first, part.to.first) - bottom_) / cell_height_, rows_);
+        const auto first_column = clampCell((std::min(part.from.second, part.to.second) - left_) / cell_width_, columns_);
+        const auto last_column = clampCell((std::max(part.from.second, part.to.second) - left_) / cell_width_, columns_);
+        for(auto row = first_row; row <= last_row; row++) {
+            for(auto column = first_column; column <= last_column; column++) {
+                callback(row * columns_ + column);
+            }
+        }
+    }
+
+    static auto clampCell(double value, std::size_t size) noexcept
+        -> std::size_t
+    {
+        if(value <= 0) {
+            return 0;
+        }
+        return std::min(static_cast<std::size_t>(value), size - 1);
+    }
+
+    std::vector<Segment> segments_;
+
+    double bottom_;
+    double left_;
+    double cell_height_;
+    double cell_width_;
+    std::size_t rows_;
+    std::size_t columns_;
+
+    // segments of cell c are cell_segments_[cell_offsets_[c] .. cell_offsets_[c + 1]]
+    std::vector<std::size_t> cell_offsets_;
+    std::vector<std::size_t> cell_segments_;
+};
+
+auto segmentsOf(const std::vector<Ring>& rings) noexcept
+    -> std::vector<Segment>
+{
+    std::vector<Segment> segments;
+    for(std::size_t r = 0; r < rings.size(); r++) {
+        const auto& ring = rings[r];
+        std::size_t first = 0;
+        for(std::size_t i = 1; i < ring.keep.size(); i++) {
+            if(ring.keep[i]) {
+                segments.emplace_back(Segment{ring.lat_lngs[first],
+                                              ring.lat_lngs[i % ring.lat_lngs.size()],
+                                              r,
+                                              first,
+                                              i});
+                first = i;
+            }
+        }
+    }
+    return segments;
+}
+
+// keeps the split point of every simplified segment which intersects another
+// segment of its own or of any other ring, until no segments intersect. the
+// segments of the original rings are assumed not to intersect, so this ends at
+// the latest when the rings are restored
+auto resolveIntersections(std::vector<Ring>& rings) noexcept
+    -> void
+{
+    while(true) {
+        const SegmentIndex index{segmentsOf(rings)};
+        const auto& segments = index.segments();
+
+        std::vector<std::uint8_t> split(segments.size(), false);
+        const auto range = utils::range(segments.size());
+        std::for_each(std::execution::par,
+                      std::begin(range),
+                      std::end(range),
+                      [&](auto i) {
+                          const auto& segment = segments[i];
+                          split[i] = segment.last - segment.first > 1
+                              and index.intersectsOther(segment);
+                      });
+
+        if(std::none_of(std::cbegin(split), std::cend(split), [](auto s) { return s; })) {
+            return;
+        }
+
+        for(std::size_t i = 0; i < segments.size(); i++) {
+            if(split[i]) {
+                const auto& segment = segments[i];
+                auto& ring = rings[segment.ring];
+                ring.keep[splitPoint(ring, segment.first, segment.last).first] = true;
+            }
+        }
+    }
+}
+
+auto toRing(const Polygon& polygon) noexcept
+    -> Ring
+{
+    Ring ring;
+    ring.lat_lngs = polygon.getLatAndLng();
+    if(ring.lat_lngs.size() > 1 and ring.lat_lngs.front() == ring.lat_lngs.back()) {
+        ring.lat_lngs.pop_back();
+    }
+
+    ring.points.reserve(ring.lat_lngs.size());
+    for(auto [lat, lng] : ring.lat_lngs) {
+        ring.points.emplace_back(Vector3D{Latitude<Degree>{lat}.toRadian(),
+                                          Longitude<Degree>{lng}.toRadian()}
+                                     .normalize());
+    }
+    return ring;
+}
+
+auto toPolygon(Polygon&& polygon, const Ring& ring) noexcept
+    -> Polygon
+{
+    // rings which do not get any smaller are kept as they are
+    const auto kept = static_cast<std::size_t>(
+        std::count(std::cbegin(ring.keep), std::cend(ring.keep), true));
+    if(kept == ring.keep.size()) {
+        return std::move(polygon);
+    }
+
+    std::vector<OSMNode> nodes;
+    nodes.reserve(kept);
+    for(std::size_t i = 0; i + 1 < ring.keep.size(); i++) {
+        if(ring.keep[i]) {
+            const auto [lat, lng] = ring.lat_lngs[i];
+            nodes.emplace_back(i, lng, lat);
+        }
+    }
+    nodes.emplace_back(nodes.front());
+
+    return Polygon{nodes};
+}
+
+} // namespace
+
+auto simplifyPolygons(const std::vector<Polygon>& polygons, double tolerance) noexcept
+    -> std::vector<Polygon>
+{
+    std::vector<Ring> rings(polygons.size());
+    std::transform(std::execution::par,
+                   std::cbegin(polygons),
+                   std::cend(polygons),
+                   std::begin(rings),
+                   [&](const auto& polygon) {
+                       auto ring = toRing(polygon);
+                       simplifyRing(ring, tolerance);
+                       return ring;
+                   });
+
+    resolveIntersections(rings);
+
+    // every polygon is replaced by its simplified ring in place
+    auto simplified = polygons;
+    std::transform(std::execution::par,
+                   std::begin(simplified),
+                   std::end(simplified),
+                   std::cbegin(rings),
+                   std::begin(simplified),
+                   [](auto& polygon, const auto& ring) {
+                       return toPolygon(std::move(polygon), ring);
+                   });
+
+    return simplified;
+}
+
+auto numberOfPoints(const std::vector<Polygon>& polygons) noexcept
+    -> std::size_t
+{
+    return std::transform_reduce(std::execution::par,
+                                 std::cbegin(polygons),
+                                 std::cend(polygons),
+                                 std::size_t{0},
+                                 std::plus<>{},
+                                 [](const auto& polygon) {
+                                     return polygon.numberOfPoints();
+                                 });
+}
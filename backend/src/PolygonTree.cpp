@@ -0,0 +1,74 @@
+#include <PolygonTree.hpp>
+#include <algorithm>
+
+
+namespace {
+
+auto unite(const BoundingBox& lhs, const BoundingBox& rhs) noexcept
+    -> BoundingBox
+{
+    return BoundingBox{std::min(lhs.bottom, rhs.bottom),
+                       std::max(lhs.top, rhs.top),
+                       std::min(lhs.left, rhs.left),
+                       std::max(lhs.right, rhs.right)};
+}
+
+} // namespace
+
+PolygonTree::PolygonTree(const std::vector<Polygon>& polygons) noexcept
+{
+    for(std::size_t i = 0; i < polygons.size(); i++) {
+        for(const auto& box : polygons[i].getBoundingBoxes()) {
+            entries_.emplace_back(Entry{box, i});
+        }
+    }
+
+    if(entries_.empty()) {
+        return;
+    }
+
+    nodes_.reserve(2 * entries_.size() / LEAF_SIZE + 1);
+    nodes_.emplace_back();
+    build(0, 0, entries_.size(), 0);
+}
+
+auto PolygonTree::build(std::size_t node, std::size_t begin, std::size_t end, std::size_t depth) noexcept
+    -> void
+{
+    auto box = entries_[begin].box;
+    for(auto i = begin + 1; i < end; i++) {
+        box = unite(box, entries_[i].box);
+    }
+    nodes_[node].box = box;
+
+    if(end - begin <= LEAF_SIZE or depth == MAX_DEPTH) {
+        nodes_[node].first = static_cast<std::uint32_t>(begin);
+        nodes_[node].count = static_cast<std::uint32_t>(end - begin);
+        return;
+    }
+
+    // split at the median center along the longer side of the box
+    const auto split_lats = box.top - box.bottom > box.right - box.left;
+    const auto center = [&](const Entry& entry) {
+        return split_lats
+            ? entry.box.bottom + entry.box.top
+            : entry.box.left + entry.box.right;
+    };
+
+    const auto middle = begin + (end - begin) / 2;
+    std::nth_element(std::begin(entries_) + begin,
+                     std::begin(entries_) + middle,
+                     std::begin(entries_) + end,
+                     [&](const auto& lhs, const auto& rhs) {
+                         return center(lhs) < center(rhs);
+                     });
+
+    const auto left_child = nodes_.size();
+    nodes_[node].first = static_cast<std::uint32_t>(left_child);
+    nodes_[node].count = 0;
+    nodes_.emplace_back();
+    nodes_.emplace_back();
+
+    build(left_child, begin, middle, depth + 1);
+    build(left_child + 1, middle, end, depth + 1);
+}
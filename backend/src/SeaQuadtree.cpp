@@ -0,0 +1,264 @@
+#include <SeaQuadtree.hpp>
+#include <Vector3D.hpp>
+#include <algorithm>
+#include <cmath>
+#include <execution>
+
+
+namespace {
+
+// margin around the edges in degrees. covers the difference between the
+// straight line in the lat/lng plane, used by the edge index and the scanline
+// filter, and the great circle arc, used by the angle sum and ray casting
+constexpr auto EDGE_MARGIN = 0.01;
+
+// edges longer than this many degrees are split into pieces, such
+// that a great circle arc stays close to the line between its points
+constexpr auto MAX_PIECE_LENGTH = 1.0;
+
+auto interleave(std::uint32_t row, std::uint32_t column) noexcept
+    -> std::uint32_t
+{
+    std::uint32_t key = 0;
+    for(std::size_t bit = 0; bit < SeaQuadtree::MAX_DEPTH; bit++) {
+        key |= ((row >> bit) & 1u) << (2 * bit + 1);
+        key |= ((column >> bit) & 1u) << (2 * bit);
+    }
+    return key;
+}
+
+auto toLatLng(const Vector3D& v) noexcept
+    -> std::pair<double, double>
+{
+    const auto lat = std::atan2(v.getZ(), std::sqrt(v.getX() * v.getX() + v.getY() * v.getY()));
+    const auto lng = std::atan2(v.getY(), v.getX());
+    return std::pair{Latitude<Radian>{lat}.toDegree().getValue(),
+                     Longitude<Radian>{lng}.toDegree().getValue()};
+}
+
+// collects the keys of all cells of the deepest level touched by the edges of a polygon
+class CellMarker
+{
+public:
+    CellMarker(std::size_t max_depth) noexcept
+        : cells_per_side_(std::uint32_t{1} << max_depth) {}
+
+    auto markEdge(std::pair<double, double> from,
+                  std::pair<double, double> to) noexcept
+        -> void
+    {
+        forEachAntimeridianPart(from, to, [&](auto part_from, auto part_to) {
+            markPart(part_from, part_to);
+        });
+    }
+
+    auto getKeys() && noexcept
+        -> std::vector<std::uint32_t>
+    {
+        return std::move(keys_);
+    }
+
+private:
+    // marks a part of an edge which does not cross the antimeridian
+    auto markPart(std::pair<double, double> from,
+                  std::pair<double, double> to) noexcept
+        -> void
+    {
+        const auto [lat_from, lng_from] = from;
+        const auto [lat_to, lng_to] = to;
+
+        const auto length = std::max(std::abs(lat_to - lat_from), std::abs(lng_to - lng_from));
+        const auto pieces = std::max(1.0, std::ceil(length / MAX_PIECE_LENGTH));
+        for(auto piece = 0.0; piece < pieces; piece++) {
+            const auto t_begin = piece / pieces;
+            const auto t_end = (piece + 1) / pieces;
+            markBox(lat_from + t_begin * (lat_to - lat_from),
+                    lng_from + t_begin * (lng_to - lng_from),
+                    lat_from + t_end * (lat_to - lat_from),
+                    lng_from + t_end * (lng_to - lng_from));
+        }
+
+        if(pieces == 1.0) {
+            return;
+        }
+
+        // long edges are also marked along the great circle, which may leave the line
+        const auto a = Vector3D{Latitude<Degree>{lat_from}.toRadian(),
+                                Longitude<Degree>{lng_from}.toRadian()}
+                           .normalize();
+        const auto b = Vector3D{Latitude<Degree>{lat_to}.toRadian(),
+                                Longitude<Degree>{lng_to}.toRadian()}
+                           .normalize();
+        auto previous = from;
+        for(auto piece = 1.0; piece <= pieces; piece++) {
+            const auto t = piece / pieces;
+            const auto point = Vector3D{a.getX() + t * (b.getX() - a.getX()),
+                                        a.getY() + t * (b.getY() - a.getY()),
+                                        a.getZ() + t * (b.getZ() - a.getZ())};
+            if(point.length() == 0.0) {
+                return;
+            }
+
+            const auto current = toLatLng(point.normalize());
+            markEdge(previous, current);
+            previous = current;
+        }
+    }
+
+    auto markBox(double lat_a, double lng_a, double lat_b, double lng_b) noexcept
+        -> void
+    {
+        const auto [min_lat, max_lat] = std::minmax(lat_a, lat_b);
+        const auto [min_lng, max_lng] = std::minmax(lng_a, lng_b);
+
+        const auto first_row = toCell(min_lat - EDGE_MARGIN + 90.0, 180.0);
+        const auto last_row = toCell(max_lat + EDGE_MARGIN + 90.0, 180.0);
+        const auto first_column = toCell(min_lng - EDGE_MARGIN + 180.0, 360.0);
+        const auto last_column = toCell(max_lng + EDGE_MARGIN + 180.0, 360.0);
+
+        for(auto row = first_row; row <= last_row; row++) {
+            for(auto column = first_column; column <= last_column; column++) {
+                // consecutive edges mostly lie in the same cell
+                const auto key = interleave(row, column);
+                if(keys_.empty() or keys_.back() != key) {
+                    keys_.emplace_back(key);
+                }
+            }
+        }
+    }
+
+    auto toCell(double offset, double extent) const noexcept
+        -> std::uint32_t
+    {
+        const auto cell = std::floor(offset / extent * cells_per_side_);
+        return static_cast<std::uint32_t>(
+            std::clamp(cell, 0.0, static_cast<double>(cells_per_side_ - 1)));
+    }
+
+    std::uint32_t cells_per_side_;
+    std::vector<std::uint32_t> keys_;
+};
+
+} // namespace
+
+SeaQuadtree::SeaQuadtree(const std::vector<Polygon>& polygons,
+                         const PolygonTree& tree,
+                         ContainmentTest test,
+                         std::size_t max_depth) noexcept
+    : max_depth_(std::min(max_depth, MAX_DEPTH))
+{
+    std::vector<std::vector<std::uint32_t>> polygon_keys(polygons.size());
+    std::transform(std::execution::par,
+                   std::cbegin(polygons),
+                   std::cend(polygons),
+                   std::begin(polygon_keys),
+                   [&](const auto& polygon) {
+                       CellMarker marker{max_depth_};
+                       const auto points = polygon.getLatAndLng();
+                       for(std::size_t i = 0; i < points.size(); i++) {
+                           marker.markEdge(points[i], points[(i + 1) % points.size()]);
+                       }
+                       return std::move(marker).getKeys();
+                   });
+
+    std::vector<std::uint32_t> keys;
+    for(auto& polygon_key : polygon_keys) {
+        keys.insert(std::end(keys), std::cbegin(polygon_key), std::cend(polygon_key));
+        polygon_key = {};
+    }
+    std::sort(std::execution::par, std::begin(keys), std::end(keys));
+    keys.erase(std::unique(std::begin(keys), std::end(keys)), std::end(keys));
+
+    std::vector<Unclassified> unclassified;
+    nodes_.emplace_back(Node{0, Cell::MIXED});
+    build(0, 0, 0, 0, keys.data(), keys.data() + keys.size(), unclassified);
+
+    std::for_each(std::execution::par,
+                  std::cbegin(unclassified),
+                  std::cend(unclassified),
+                  [&](const auto& leaf) {
+                      const auto [lat, lng] = cellCenter(leaf.depth, leaf.row, leaf.column);
+                      const auto p = Vector3D{lat.toRadian(), lng.toRadian()}.normalize();
+                      const auto is_land = tree.anyOf(lat, lng, [&](auto polygon) {
+                          return polygons[polygon].pointInPolygon(lat, lng, p, test);
+                      });
+                      nodes_[leaf.node].cell = is_land ? Cell::LAND : Cell::WATER;
+                  });
+}
+
+auto SeaQuadtree::build(std::size_t node,
+                        std::size_t depth,
+                        std::uint32_t row,
+                        std::uint32_t column,
+                        const std::uint32_t* keys_begin,
+                        const std::uint32_t* keys_end,
+                        std::vector<Unclassified>& unclassified) noexcept
+    -> void
+{
+    if(keys_begin == keys_end) {
+        unclassified.emplace_back(Unclassified{node, depth, row, column});
+        return;
+    }
+
+    if(depth == max_depth_) {
+        nodes_[node].cell = Cell::MIXED;
+        return;
+    }
+
+    const auto children = nodes_.size();
+    nodes_[node].children = static_cast<std::uint32_t>(children);
+    nodes_.resize(children + 4, Node{0, Cell::MIXED});
+
+    // keys of the deepest level inside of a child share its key as prefix
+    const auto shift = 2 * (max_depth_ - depth - 1);
+    for(std::uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+        const auto child_row = 2 * row + (quadrant >> 1);
+        const auto child_column = 2 * column + (quadrant & 1);
+        const auto first_key = interleave(child_row, child_column) << shift;
+        const auto last_key = first_key + ((std::uint32_t{1} << shift) - 1);
+
+        const auto child_begin = std::lower_bound(keys_begin, keys_end, first_key);
+        const auto child_end = std::upper_bound(child_begin, keys_end, last_key);
+
+        build(children + quadrant,
+              depth + 1,
+              child_row,
+              child_column,
+              child_begin,
+              child_end,
+              unclassified);
+    }
+}
+
+auto SeaQuadtree::cellCenter(std::size_t depth, std::uint32_t row, std::uint32_t column) const noexcept
+    -> std::pair<Latitude<Degree>, Longitude<Degree>>
+{
+    const auto cells = static_cast<double>(std::uint32_t{1} << depth);
+    return std::pair{Latitude<Degree>{(row + 0.5) * 180.0 / cells - 90.0},
+                     Longitude<Degree>{(column + 0.5) * 360.0 / cells - 180.0}};
+}
+
+auto SeaQuadtree::classify(Latitude<Degree> lat, Longitude<Degree> lng) const noexcept
+    -> Cell
+{
+    const auto cells_per_side = std::uint32_t{1} << max_depth_;
+    const auto toCell = [&](double offset, double extent) {
+        const auto cell = std::floor(offset / extent * cells_per_side);
+        return static_cast<std::uint32_t>(
+            std::clamp(cell, 0.0, static_cast<double>(cells_per_side - 1)));
+    };
+
+    const auto row = toCell(lat.getValue() + 90.0, 180.0);
+    const auto column = toCell(lng.getValue() + 180.0, 360.0);
+
+    std::size_t node = 0;
+    std::size_t depth = 0;
+    while(nodes_[node].children != 0) {
+        const auto shift = max_depth_ - depth - 1;
+        const auto quadrant = (((row >> shift) & 1u) << 1) | ((column >> shift) & 1u);
+        node = nodes_[node].children + quadrant;
+        depth++;
+    }
+
+    return nodes_[node].cell;
+}
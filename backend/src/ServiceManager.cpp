@@ -36,22 +36,25 @@ auto ServiceManager::snapNode(Latitude<Degree> lat, Longitude<Degree> lng) const
 
     nlohmann::json result;
 
-    result["id"] = snapped;
+    result["id"] = grid_.toGridId(snapped);
     result["lat"] = new_lat.getValue();
     result["lng"] = new_lng.getValue();
 
     return result;
 }
 
-auto ServiceManager::getRoute(NodeId source, NodeId target)
+auto ServiceManager::getRoute(std::size_t source, std::size_t target)
     -> std::optional<nlohmann::json>
 {
-    if(!grid_.isValidId(source) or !grid_.isValidId(target)) {
+    // clients address the nodes by their grid ids
+    const auto source_node = grid_.fromGridId(source);
+    const auto target_node = grid_.fromGridId(target);
+    if(source_node == NON_EXISTENT or target_node == NON_EXISTENT) {
         return std::nullopt;
     }
 
     std::unique_lock lock{dijkstra_mtx_};
-    auto routing_result = dijkstra_.findRoute(source, target);
+    auto routing_result = dijkstra_.findRoute(source_node, target_node);
     lock.unlock();
 
     nlohmann::json result;
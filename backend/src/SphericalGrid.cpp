@@ -1,14 +1,87 @@
 #include <Constants.hpp>
 #include <LatLng.hpp>
+#include <MappedFile.hpp>
 #include <Polygon.hpp>
+#include <PolygonTree.hpp>
 #include <Range.hpp>
-#include <SeaRectangle.hpp>
+#include <SeaQuadtree.hpp>
 #include <SphericalGrid.hpp>
 #include <Utils.hpp>
 #include <Vector3D.hpp>
 #include <algorithm>
 #include <execution>
+#include <numeric>
 #include <queue>
+#include <tuple>
+
+namespace {
+
+// "SRGRID" followed by two zero bytes
+constexpr auto GRID_FILE_MAGIC = std::uint64_t{0x0000444952475253ull};
+constexpr auto GRID_FILE_VERSION = std::uint32_t{2};
+
+auto packBits(const std::vector<std::uint8_t>& bits) noexcept
+    -> std::vector<std::uint64_t>
+{
+    std::vector<std::uint64_t> words((bits.size() + 63) / 64, 0);
+    for(std::size_t i = 0; i < bits.size(); i++) {
+        if(bits[i]) {
+            words[i / 64] |= std::uint64_t{1} << (i % 64);
+        }
+    }
+    return words;
+}
+
+// latitude crossing of a row of the grid with a polygon edge
+struct RowCrossing
+{
+    std::uint32_t row;
+    double lng;
+};
+
+// calls `callback(row, lng)` for every row whose latitude is crossed by the edge
+// between the two points. a row is crossed if exactly one of the points lies
+// above it. edges across the antimeridian are split at it
+template<class Callback>
+auto forEachRowCrossing(std::pair<double, double> from,
+                        std::pair<double, double> to,
+                        const std::vector<double>& row_lats,
+                        Callback&& callback) noexcept
+    -> void
+{
+    forEachAntimeridianPart(from, to, [&](auto part_from, auto part_to) {
+        const auto [lat_from, lng_from] = part_from;
+        const auto [lat_to, lng_to] = part_to;
+
+        // rows with min_lat <= lat < max_lat
+        const auto [min_lat, max_lat] = std::minmax(lat_from, lat_to);
+        const auto first = std::lower_bound(std::begin(row_lats), std::end(row_lats), min_lat);
+        const auto last = std::lower_bound(first, std::end(row_lats), max_lat);
+
+        for(auto iter = first; iter != last; iter++) {
+            const auto row_lat = *iter;
+            const auto lng = lng_from + (row_lat - lat_from) * (lng_to - lng_from) / (lat_to - lat_from);
+            callback(std::distance(std::begin(row_lats), iter), lng);
+        }
+    });
+}
+
+template<class Callback>
+auto forEachRowCrossing(const Polygon& polygon,
+                        const std::vector<double>& row_lats,
+                        Callback&& callback) noexcept
+    -> void
+{
+    const auto points = polygon.getLatAndLng();
+    for(std::size_t i = 0; i < points.size(); i++) {
+        forEachRowCrossing(points[i],
+                           points[(i + 1) % points.size()],
+                           row_lats,
+                           callback);
+    }
+}
+
+} // namespace
 
 SphericalGrid::SphericalGrid(std::size_t number_of_nodes) noexcept
     : a_(4 * PI / number_of_nodes),
@@ -28,6 +101,9 @@ SphericalGrid::SphericalGrid(std::size_t number_of_nodes) noexcept
         }
     }
     first_index_of_[n_rows_] = counter; // add last dummy entry
+
+    lats_view_ = nonstd::span<const Latitude<Degree>>{lats_.data(), lats_.size()};
+    lngs_view_ = nonstd::span<const Longitude<Degree>>{lngs_.data(), lngs_.size()};
 }
 
 auto SphericalGrid::sphericalToGrid(Latitude<Radian> theta, Longitude<Radian> phi) const noexcept
@@ -44,7 +120,7 @@ auto SphericalGrid::sphericalToGrid(Latitude<Radian> theta, Longitude<Radian> ph
 auto SphericalGrid::idToLatLng(NodeId n) const noexcept
     -> std::pair<Latitude<Degree>, Longitude<Degree>>
 {
-    return std::pair{lats_[n], lngs_[n]};
+    return std::pair{lats_view_[n], lngs_view_[n]};
 }
 
 auto SphericalGrid::gridToSpherical(size_t m, size_t n) const
@@ -60,7 +136,14 @@ auto SphericalGrid::gridToSpherical(size_t m, size_t n) const
 auto SphericalGrid::size() const noexcept
     -> std::size_t
 {
-    return lats_.size();
+    return first_index_of_.back();
+}
+
+auto SphericalGrid::nodeSpacing() const noexcept
+    -> double
+{
+    // every node covers an area of a_ on the unit sphere
+    return std::sqrt(a_) * EARTH_RADIUS_IN_METERS;
 }
 
 auto SphericalGrid::gridToID(size_t m, size_t n) const noexcept
@@ -135,31 +218,14 @@ auto SphericalGrid::getUpperNeighbours(size_t m, size_t n) const noexcept
 auto SphericalGrid::getNeighbours(size_t m, size_t n) const noexcept
     -> std::vector<size_t>
 {
-    auto grid_neighbours = concat(
-        getRowNeighbours(m, n),
-        getUpperNeighbours(m, n),
-        getLowerNeighbours(m, n));
-
     std::vector<size_t> id_neighbours;
 
-    // map (m,n) to IDs
-    std::transform(
-        grid_neighbours.begin(),
-        grid_neighbours.end(),
-        std::back_inserter(id_neighbours),
-        [&](auto neighbour) {
-            return gridToID(neighbour.first, neighbour.second);
-        });
-
-    // filter out land nodes
-    id_neighbours.erase(
-        std::remove_if(
-            std::begin(id_neighbours),
-            std::end(id_neighbours),
-            [&](auto id) {
-                return indexIsLand(id);
-            }),
-        std::end(id_neighbours));
+    // land nodes are filtered out
+    forEachNeighbour(m, n, [&](auto id) {
+        if(!indexIsLand(id)) {
+            id_neighbours.emplace_back(id);
+        }
+    });
     return id_neighbours;
 }
 
@@ -174,11 +240,11 @@ auto SphericalGrid::getNeighbours(std::size_t id) const noexcept
 auto SphericalGrid::distanceBetween(NodeId from, NodeId to) const noexcept
     -> Distance
 {
-    const auto from_lat = lats_[from];
-    const auto to_lat = lats_[to];
+    const auto from_lat = lats_view_[from];
+    const auto to_lat = lats_view_[to];
 
-    const auto from_lng = lngs_[from];
-    const auto to_lng = lngs_[to];
+    const auto from_lng = lngs_view_[from];
+    const auto to_lng = lngs_view_[to];
 
     const auto distance_double = ::distanceBetween(from_lat, from_lng, to_lat, to_lng);
     const auto distance_in_cm = std::round(distance_double * 100);
@@ -194,8 +260,8 @@ auto SphericalGrid::snapToNode(Latitude<Degree> lat, Longitude<Degree> lng) cons
 
     std::priority_queue candidates(
         [&](auto id1, auto id2) {
-            return ::distanceBetween(lat, lng, lats_[id1], lngs_[id1])
-                > ::distanceBetween(lat, lng, lats_[id2], lngs_[id2]);
+            return ::distanceBetween(lat, lng, lats_view_[id1], lngs_view_[id1])
+                > ::distanceBetween(lat, lng, lats_view_[id2], lngs_view_[id2]);
         },
         std::vector{source_id});
 
@@ -213,79 +279,423 @@ auto SphericalGrid::snapToNode(Latitude<Degree> lat, Longitude<Degree> lng) cons
 }
 
 auto SphericalGrid::getLats() const noexcept
-    -> const std::vector<Latitude<Degree>>&
+    -> nonstd::span<const Latitude<Degree>>
 {
-    return lats_;
+    return lats_view_;
 }
 
 auto SphericalGrid::getLngs() const noexcept
-    -> const std::vector<Longitude<Degree>>&
+    -> nonstd::span<const Longitude<Degree>>
 {
-    return lngs_;
+    return lngs_view_;
 }
 
-auto SphericalGrid::getLats() noexcept
-    -> std::vector<Latitude<Degree>>&
+auto SphericalGrid::isValidId(NodeId from) const noexcept
+    -> bool
 {
-    return lats_;
+    return from < lngs_view_.size();
 }
 
-auto SphericalGrid::getLngs() noexcept
-    -> std::vector<Longitude<Degree>>&
+auto SphericalGrid::indexIsWater(std::size_t idx) const noexcept
+    -> bool
 {
-    return lngs_;
+    return (is_water_view_[idx / 64] >> (idx % 64)) & 1;
 }
 
-auto SphericalGrid::isValidId(NodeId from) const noexcept
+auto SphericalGrid::indexIsLand(std::size_t idx) const noexcept
     -> bool
 {
-    return from < lngs_.size();
+    return !indexIsWater(idx);
 }
 
-auto SphericalGrid::indexIsWater(std::size_t idx) const noexcept
-    -> bool
+auto SphericalGrid::ownWaterMask() noexcept
+    -> void
 {
-    return is_water_[idx];
+    if(is_water_view_.data() != is_water_.data()) {
+        is_water_.assign(std::cbegin(is_water_view_), std::cend(is_water_view_));
+        is_water_view_ = nonstd::span<const std::uint64_t>{is_water_.data(), is_water_.size()};
+    }
 }
 
-auto SphericalGrid::indexIsLand(std::size_t idx) const noexcept
-    -> bool
+auto SphericalGrid::setWater(std::size_t idx, bool water) noexcept
+    -> void
 {
-    return !is_water_[idx];
+    const auto bit = std::uint64_t{1} << (idx % 64);
+    is_water_[idx / 64] = water
+        ? is_water_[idx / 64] | bit
+        : is_water_[idx / 64] & ~bit;
 }
 
-auto SphericalGrid::filter(const std::vector<Polygon>& polygons) noexcept
+auto SphericalGrid::filter(const std::vector<Polygon>& polygons,
+                           FilterMode mode,
+                           ContainmentTest test) noexcept
     -> void
 {
-    const auto range = utils::range(lats_.size());
-    is_water_.resize(range.size());
+    if(mode == FilterMode::SCANLINE) {
+        const auto is_water = filterRows(polygons, std::vector<std::uint8_t>(n_rows_, true), test);
+        is_water_ = packBits(is_water);
+        is_water_view_ = nonstd::span<const std::uint64_t>{is_water_.data(), is_water_.size()};
+        return;
+    }
+
+    // the cells of the deepest level of the quadtree are at least as high as the rows
+    const PolygonTree tree{polygons};
+    const auto quadtree_depth = static_cast<std::size_t>(std::floor(std::log2(n_rows_)));
+    const SeaQuadtree quadtree{polygons, tree, test, quadtree_depth};
+
+    const auto range = utils::range(lats_view_.size());
 
+    // the nodes are classified into bytes first, concurrent
+    // writes to neighbouring bits of a std::vector<bool> race
+    std::vector<std::uint8_t> is_water(range.size());
     std::transform(std::execution::par,
                    std::cbegin(range),
                    std::cend(range),
-                   std::begin(is_water_),
-                   [&](auto idx) {
-                       const auto lat = lats_[idx];
-                       const auto lng = lngs_[idx];
+                   std::begin(is_water),
+                   [&](auto idx) -> std::uint8_t {
+                       const auto lat = lats_view_[idx];
+                       const auto lng = lngs_view_[idx];
 
                        if(lat < -79.0) {
                            return false;
                        }
 
-                       //check the predefined rectangles if
-                       //the node is definitly in the ocean
-                       //if so, the polygon check can be avoided
-                       if(isDefinitlySea(lat, lng)) {
-                           return true;
+                       //only nodes in cells of the quadtree crossed
+                       //by a coastline need to be tested against the polygons
+                       const auto cell = quadtree.classify(lat, lng);
+                       if(cell != SeaQuadtree::Cell::MIXED) {
+                           return cell == SeaQuadtree::Cell::WATER;
                        }
 
                        const auto p = Vector3D{lat.toRadian(), lng.toRadian()}.normalize();
+                       if(mode == FilterMode::POLYGON_TREE) {
+                           return !tree.anyOf(lat, lng, [&](auto polygon) {
+                               return polygons[polygon].pointInPolygon(lat, lng, p, test);
+                           });
+                       }
+
                        return std::none_of(std::cbegin(polygons),
                                            std::cend(polygons),
                                            [&](const Polygon& polygon) {
-                                               return polygon.pointInPolygon(lat, lng, p);
+                                               return polygon.pointInPolygon(lat, lng, p, test);
                                            });
                    });
+
+    is_water_ = packBits(is_water);
+    is_water_view_ = nonstd::span<const std::uint64_t>{is_water_.data(), is_water_.size()};
+}
+
+auto SphericalGrid::refilter(const std::vector<Polygon>& polygons,
+                             const std::vector<BoundingBox>& boxes,
+                             FilterMode mode,
+                             ContainmentTest test) noexcept
+    -> std::size_t
+{
+    std::vector<double> row_lats(n_rows_);
+    for(std::size_t m = 0; m < n_rows_; m++) {
+        row_lats[m] = Latitude<Radian>{calcTheta(m)}.toDegree() - 90;
+    }
+
+    // the rows are sorted by latitude and the nodes of every row by longitude
+    std::vector<std::uint8_t> rows(n_rows_, false);
+    std::vector<std::size_t> nodes;
+    for(const auto& box : boxes) {
+        const auto first_row = std::lower_bound(std::cbegin(row_lats), std::cend(row_lats), box.bottom.getValue());
+        const auto last_row = std::upper_bound(first_row, std::cend(row_lats), box.top.getValue());
+        for(auto row = first_row; row != last_row; row++) {
+            const auto m = static_cast<std::size_t>(std::distance(std::cbegin(row_lats), row));
+            rows[m] = true;
+            if(mode == FilterMode::SCANLINE) {
+                continue;
+            }
+
+            const auto row_begin = std::cbegin(lngs_view_) + first_index_of_[m];
+            const auto row_end = std::cbegin(lngs_view_) + first_index_of_[m + 1];
+            const auto first = std::lower_bound(row_begin, row_end, box.left);
+            const auto last = std::upper_bound(first, row_end, box.right);
+            for(auto iter = first; iter != last; iter++) {
+                nodes.emplace_back(std::distance(std::cbegin(lngs_view_), iter));
+            }
+        }
+    }
+
+    // the parity of a row depends on all of its crossings, the rows are filled as a
+    // whole such that the grid stays classified by the same method as in `filter`
+    if(mode == FilterMode::SCANLINE) {
+        const auto is_water = filterRows(polygons, rows, test);
+
+        ownWaterMask();
+        std::size_t changed = 0;
+        for(std::size_t m = 0; m < n_rows_; m++) {
+            if(!rows[m]) {
+                continue;
+            }
+            for(auto idx = first_index_of_[m]; idx < first_index_of_[m + 1]; idx++) {
+                const auto water = static_cast<bool>(is_water[idx]);
+                changed += indexIsWater(idx) != water;
+                setWater(idx, water);
+            }
+        }
+
+        return changed;
+    }
+
+    std::sort(std::execution::par, std::begin(nodes), std::end(nodes));
+    nodes.erase(std::unique(std::begin(nodes), std::end(nodes)), std::end(nodes));
+
+    const PolygonTree tree{polygons};
+    std::vector<std::uint8_t> is_water(nodes.size());
+    std::transform(std::execution::par,
+                   std::cbegin(nodes),
+                   std::cend(nodes),
+                   std::begin(is_water),
+                   [&](auto idx) -> std::uint8_t {
+                       const auto lat = lats_view_[idx];
+                       const auto lng = lngs_view_[idx];
+                       if(lat < -79.0) {
+                           return false;
+                       }
+
+                       const auto p = Vector3D{lat.toRadian(), lng.toRadian()}.normalize();
+                       return !tree.anyOf(lat, lng, [&](auto polygon) {
+                           return polygons[polygon].pointInPolygon(lat, lng, p, test);
+                       });
+                   });
+
+    ownWaterMask();
+    std::size_t changed = 0;
+    for(std::size_t i = 0; i < nodes.size(); i++) {
+        const auto water = static_cast<bool>(is_water[i]);
+        changed += indexIsWater(nodes[i]) != water;
+        setWater(nodes[i], water);
+    }
+
+    return changed;
+}
+
+auto SphericalGrid::filterRows(const std::vector<Polygon>& polygons,
+                               const std::vector<std::uint8_t>& rows,
+                               ContainmentTest test) noexcept
+    -> std::vector<std::uint8_t>
+{
+    std::vector<double> row_lats(n_rows_);
+    for(std::size_t m = 0; m < n_rows_; m++) {
+        row_lats[m] = Latitude<Radian>{calcTheta(m)}.toDegree() - 90;
+    }
+
+    // collect the crossings of all polygons, counted first
+    // such that every polygon can write its own range in parallel
+    std::vector<std::size_t> crossing_offsets(polygons.size() + 1, 0);
+    std::transform(std::execution::par,
+                   std::cbegin(polygons),
+                   std::cend(polygons),
+                   std::begin(crossing_offsets) + 1,
+                   [&](const auto& polygon) {
+                       std::size_t counter = 0;
+                       forEachRowCrossing(polygon, row_lats, [&](auto row, auto /* lng */) {
+                           counter += rows[row];
+                       });
+                       return counter;
+                   });
+    std::partial_sum(std::cbegin(crossing_offsets),
+                     std::cend(crossing_offsets),
+                     std::begin(crossing_offsets));
+
+    std::vector<RowCrossing> crossings(crossing_offsets.back());
+    const auto polygon_range = utils::range(polygons.size());
+    std::for_each(std::execution::par,
+                  std::cbegin(polygon_range),
+                  std::cend(polygon_range),
+                  [&](auto idx) {
+                      auto position = crossing_offsets[idx];
+                      forEachRowCrossing(polygons[idx], row_lats, [&](auto row, auto lng) {
+                          if(rows[row]) {
+                              crossings[position++] = RowCrossing{static_cast<std::uint32_t>(row), lng};
+                          }
+                      });
+                  });
+
+    std::sort(std::execution::par,
+              std::begin(crossings),
+              std::end(crossings),
+              [](const auto& lhs, const auto& rhs) {
+                  return std::tie(lhs.row, lhs.lng) < std::tie(rhs.row, rhs.lng);
+              });
+
+    // the nodes of a row toggle between land and water at every crossing. one
+    // node per row is tested against the polygons, it is taken from the middle of
+    // the largest gap between two crossings to keep it away from the coast
+    const PolygonTree tree{polygons};
+    std::vector<std::uint8_t> is_water(lats_view_.size());
+    const auto row_range = utils::range(n_rows_);
+    std::for_each(std::execution::par,
+                  std::cbegin(row_range),
+                  std::cend(row_range),
+                  [&](auto m) {
+                      const auto first = first_index_of_[m];
+                      const auto last = first_index_of_[m + 1];
+                      if(first == last or !rows[m]) {
+                          return;
+                      }
+
+                      const auto row_begin = std::lower_bound(std::cbegin(crossings),
+                                                              std::cend(crossings),
+                                                              m,
+                                                              [](const auto& crossing, auto row) {
+                                                                  return crossing.row < row;
+                                                              });
+                      const auto row_end = std::find_if(row_begin,
+                                                        std::cend(crossings),
+                                                        [&](const auto& crossing) {
+                                                            return crossing.row != m;
+                                                        });
+
+                      const auto is_land = [&](auto idx) {
+                          const auto lat = lats_view_[idx];
+                          const auto lng = lngs_view_[idx];
+                          const auto p = Vector3D{lat.toRadian(), lng.toRadian()}.normalize();
+                          return tree.anyOf(lat, lng, [&](auto polygon) {
+                              return polygons[polygon].pointInPolygon(lat, lng, p, test);
+                          });
+                      };
+
+                      // the crossings of a closed ring with a row come in pairs. a row crossed
+                      // an odd number of times, by a ring around a pole which is not closed
+                      // along the antimeridian, has no consistent parity and every node is tested
+                      if(std::distance(row_begin, row_end) % 2 != 0) {
+                          for(auto idx = first; idx < last; idx++) {
+                              is_water[idx] = lats_view_[idx] >= -79.0 and !is_land(idx);
+                          }
+                          return;
+                      }
+
+                      // parity of the crossings between the first node and every node
+                      auto crossing = row_begin;
+                      auto odd = false;
+                      for(auto idx = first; idx < last; idx++) {
+                          while(crossing != row_end and crossing->lng <= lngs_view_[idx]) {
+                              odd = !odd;
+                              crossing++;
+                          }
+                          is_water[idx] = odd;
+                      }
+
+                      auto reference_lng = lngs_view_[first].getValue();
+                      if(row_begin != row_end) {
+                          // the gap from the last to the first crossing wraps around the antimeridian
+                          auto largest_gap = row_begin->lng + 360.0 - std::prev(row_end)->lng;
+                          reference_lng = std::prev(row_end)->lng + largest_gap / 2;
+                          for(auto iter = row_begin; std::next(iter) != row_end; iter++) {
+                              const auto gap = std::next(iter)->lng - iter->lng;
+                              if(gap > largest_gap) {
+                                  largest_gap = gap;
+                                  reference_lng = iter->lng + gap / 2;
+                              }
+                          }
+                      }
+
+                      const auto columns = last - first;
+                      const auto column = static_cast<std::size_t>(
+                          std::round((reference_lng + 180.0) * columns / 360.0));
+                      const auto reference = first + column % columns;
+
+                      const auto first_is_land = is_land(reference) != static_cast<bool>(is_water[reference]);
+
+                      for(auto idx = first; idx < last; idx++) {
+                          const auto land = first_is_land != static_cast<bool>(is_water[idx]);
+                          is_water[idx] = lats_view_[idx] >= -79.0 and !land;
+                      }
+                  });
+
+    return is_water;
+}
+
+auto SphericalGrid::save(const std::string& path,
+                         std::uint64_t data_checksum,
+                         std::size_t number_of_nodes) const noexcept
+    -> bool
+{
+    return writeFileAtomically(path, [&](BinaryWriter& writer) {
+        writer.write(GRID_FILE_MAGIC);
+        writer.write(GRID_FILE_VERSION);
+        writer.write(data_checksum);
+        writer.write(static_cast<std::uint64_t>(number_of_nodes));
+        write(writer);
+        return writer.good();
+    });
+}
+
+auto SphericalGrid::load(std::string_view path,
+                         std::uint64_t data_checksum,
+                         std::size_t number_of_nodes) noexcept
+    -> std::optional<SphericalGrid>
+{
+    auto file = MappedFile::open(path);
+    if(!file) {
+        return std::nullopt;
+    }
+
+    BinaryReader reader{file.value()};
+    if(reader.read<std::uint64_t>() != GRID_FILE_MAGIC
+       or reader.read<std::uint32_t>() != GRID_FILE_VERSION
+       or reader.read<std::uint64_t>() != data_checksum
+       or reader.read<std::uint64_t>() != number_of_nodes) {
+        return std::nullopt;
+    }
+
+    auto grid = read(reader);
+    if(grid) {
+        grid->file_ = std::move(file);
+    }
+    return grid;
+}
+
+auto SphericalGrid::write(BinaryWriter& writer) const noexcept
+    -> void
+{
+    // the coordinates are stored as plain doubles, which is their layout in memory
+    writer.write(a_);
+    writer.write(static_cast<std::uint64_t>(n_rows_));
+    writer.write(d_phi_);
+    writer.writeArray(first_index_of_);
+    writer.writeArray(lats_view_);
+    writer.writeArray(lngs_view_);
+    writer.writeArray(is_water_view_);
+}
+
+auto SphericalGrid::read(BinaryReader& reader) noexcept
+    -> std::optional<SphericalGrid>
+{
+    const auto a = reader.read<double>();
+    const auto n_rows = reader.read<std::uint64_t>();
+    const auto d_phi = reader.read<double>();
+    auto first_index_of = reader.readVector<std::size_t>();
+    const auto lats = reader.readArray<Latitude<Degree>>();
+    const auto lngs = reader.readArray<Longitude<Degree>>();
+    const auto is_water = reader.readArray<std::uint64_t>();
+
+    if(!a or !n_rows or !d_phi or !first_index_of or !lats or !lngs or !is_water) {
+        return std::nullopt;
+    }
+
+    const auto size = lats->size();
+    if(first_index_of->size() != n_rows.value() + 1
+       or first_index_of->back() != size
+       or lngs->size() != size
+       or is_water->size() != (size + 63) / 64) {
+        return std::nullopt;
+    }
+
+    SphericalGrid grid;
+    grid.a_ = a.value();
+    grid.n_rows_ = n_rows.value();
+    grid.d_phi_ = d_phi.value();
+    grid.first_index_of_ = std::move(first_index_of.value());
+    grid.lats_view_ = lats.value();
+    grid.lngs_view_ = lngs.value();
+    grid.is_water_view_ = is_water.value();
+
+    return grid;
 }
 
 auto SphericalGrid::nCols(size_t m) const
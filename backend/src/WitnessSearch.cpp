@@ -0,0 +1,120 @@
+#include <ContractionGraph.hpp>
+#include <Graph.hpp>
+#include <WitnessSearch.hpp>
+
+template<class GraphType>
+BasicWitnessSearch<GraphType>::BasicWitnessSearch(const GraphType& graph,
+                                                  WitnessSearchLimits limits) noexcept
+    : graph_(graph),
+      limits_(limits),
+      distances_(graph_.size(), UNREACHABLE),
+      hops_(graph_.size(), 0),
+      settled_(graph_.size(), false),
+      is_target_(graph_.size(), false) {}
+
+template<class GraphType>
+auto BasicWitnessSearch<GraphType>::run(NodeId source,
+                                        NodeId avoided,
+                                        const std::vector<NodeId>& targets,
+                                        Distance max_dist) noexcept
+    -> void
+{
+    reset();
+    statistics_.searches++;
+
+    // targets may be given more than once
+    std::size_t unsettled_targets = 0;
+    for(auto target : targets) {
+        if(!is_target_[target]) {
+            is_target_[target] = true;
+            targets_.emplace_back(target);
+            unsettled_targets++;
+        }
+    }
+
+    distances_[source] = 0;
+    hops_[source] = 0;
+    touched_.emplace_back(source);
+    pq_.emplace(0, source);
+
+    std::uint32_t number_settled = 0;
+    bool hop_limited = false;
+    while(!pq_.empty()) {
+        const auto [current_dist, current_node] = pq_.top();
+        pq_.pop();
+
+        if(settled_[current_node]) {
+            continue;
+        }
+        if(current_dist > max_dist) {
+            break;
+        }
+
+        settled_[current_node] = true;
+        number_settled++;
+        if(is_target_[current_node] and --unsettled_targets == 0) {
+            break;
+        }
+        if(limits_.max_settled != 0 and number_settled >= limits_.max_settled) {
+            statistics_.settle_limit_hits++;
+            break;
+        }
+        if(limits_.max_hops != 0 and hops_[current_node] >= limits_.max_hops) {
+            hop_limited = true;
+            continue;
+        }
+
+        graph_.forEachEdge(current_node, [&](auto target, auto dist) {
+            if(target == avoided or graph_.nodeContracted(target)) {
+                return;
+            }
+
+            const auto new_dist = current_dist + dist;
+            if(new_dist < distances_[target]) {
+                if(distances_[target] == UNREACHABLE) {
+                    touched_.emplace_back(target);
+                }
+                distances_[target] = new_dist;
+                hops_[target] = hops_[current_node] + 1;
+                pq_.emplace(new_dist, target);
+            }
+        });
+    }
+
+    if(hop_limited and unsettled_targets > 0) {
+        statistics_.hop_limit_hits++;
+    }
+}
+
+template<class GraphType>
+auto BasicWitnessSearch<GraphType>::distanceTo(NodeId node) const noexcept
+    -> Distance
+{
+    return distances_[node];
+}
+
+template<class GraphType>
+auto BasicWitnessSearch<GraphType>::getStatistics() const noexcept
+    -> const WitnessSearchStatistics&
+{
+    return statistics_;
+}
+
+template<class GraphType>
+auto BasicWitnessSearch<GraphType>::reset() noexcept
+    -> void
+{
+    for(auto node : touched_) {
+        distances_[node] = UNREACHABLE;
+        settled_[node] = false;
+    }
+    for(auto target : targets_) {
+        is_target_[target] = false;
+    }
+    touched_.clear();
+    targets_.clear();
+    pq_ = Queue{};
+}
+
+template class BasicWitnessSearch<Graph>;
+template class BasicWitnessSearch<ContractionGraph>;
@@ -1,10 +1,15 @@
 #include <CHDijkstra.hpp>
 #include <Dijkstra.hpp>
 #include <Environment.hpp>
+#include <ImplicitGridGraph.hpp>
+#include <MappedFile.hpp>
 #include <PBFExtractor.hpp>
+#include <PolygonSimplification.hpp>
+#include <PolygonTree.hpp>
 #include <ServiceManager.hpp>
 #include <SphericalGrid.hpp>
 #include <Vector3D.hpp>
+#include <array>
 #include <chrono>
 #include <csignal>
 #include <cstdint>
@@ -13,6 +18,8 @@
 #include <fmt/ranges.h>
 #include <fstream>
 #include <iostream>
+#include <numeric>
+#include <random>
 
 static std::condition_variable condition;
 static std::mutex mutex;
@@ -69,54 +76,537 @@ void benchmark(
     myfile.close();
 }
 
+// filters a fresh grid with every filter mode and writes the time it took,
+// the number of water nodes and the nodes classified differently
+// than by the linear scan to a file
+static auto benchmarkFilter(const Environment& env,
+                            const std::vector<Polygon>& polygons) noexcept
+    -> void
+{
+    fmt::print("Starting filter benchmark\n");
+    std::string log = "mode,filter_time,water_nodes,differences\n";
 
-auto main() -> int
+    const auto modes = std::array{std::pair{"linear_scan", FilterMode::LINEAR_SCAN},
+                                  std::pair{"polygon_tree", FilterMode::POLYGON_TREE},
+                                  std::pair{"scanline", FilterMode::SCANLINE}};
+
+    std::optional<SphericalGrid> reference;
+    for(auto [name, mode] : modes) {
+        SphericalGrid grid{env.getNumberOfSphereNodes()};
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        grid.filter(polygons, mode, env.getContainmentTest());
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        auto time_diff_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+
+        std::size_t water_nodes = 0;
+        std::size_t differences = 0;
+        for(std::size_t i = 0; i < grid.size(); i++) {
+            water_nodes += grid.indexIsWater(i);
+            if(reference) {
+                differences += grid.indexIsWater(i) != reference->indexIsWater(i);
+            }
+        }
+
+        fmt::print("{}: {}ms, {} water nodes, {} differences\n",
+                   name, time_diff_ms, water_nodes, differences);
+        log += fmt::format("{},{},{},{}\n", name, time_diff_ms, water_nodes, differences);
+
+        if(!reference) {
+            reference.emplace(std::move(grid));
+        }
+    }
+
+    std::ofstream myfile;
+    myfile.open(fmt::format("../results/filter_{}.csv", env.getNumberOfSphereNodes()));
+    myfile << log;
+    myfile.close();
+}
+
+// tests random grid nodes against the polygons whose bounding box contains
+// them with every containment test and writes the time it took, the number
+// of points inside and the points classified differently than by the angle sum.
+// the edge index is only used by the edge_index test, the others check all edges
+static auto benchmarkContainment(const Environment& env,
+                                 const std::vector<Polygon>& polygons) noexcept
+    -> void
 {
-    auto environment = [] {
-        auto environment_opt = loadEnv();
-        if(!environment_opt) {
-            std::cout << "the environment variables could not be understood" << std::endl;
-            std::cout << "using default values" << std::endl;
+    constexpr std::size_t NUMBER_OF_TESTS = 10000;
+
+    fmt::print("Starting containment benchmark\n");
+    std::string log = "test,containment_time,inside,differences\n";
+
+    const SphericalGrid grid{env.getNumberOfSphereNodes()};
+    const PolygonTree tree{polygons};
 
-            return Environment{9090,
-                               //    "../data/antarctica-latest.osm.pbf",
-                               "../data/planet-coastlines.pbf",
-                               100};
+    std::vector<std::size_t> nodes(grid.size());
+    std::iota(std::begin(nodes), std::end(nodes), 0);
+    std::shuffle(std::begin(nodes), std::end(nodes), std::mt19937{42});
+
+    std::vector<std::tuple<Latitude<Degree>, Longitude<Degree>, Vector3D, std::size_t>> tests;
+    for(auto node : nodes) {
+        if(tests.size() >= NUMBER_OF_TESTS) {
+            break;
         }
+        const auto [lat, lng] = grid.idToLatLng(node);
+        const auto p = Vector3D{lat.toRadian(), lng.toRadian()}.normalize();
+        tree.anyOf(lat, lng, [&](auto polygon) {
+            tests.emplace_back(lat, lng, p, polygon);
+            return false;
+        });
+    }
 
-        return environment_opt.value();
-    }();
+    const auto containment_tests = std::array{std::pair{"angle_sum", ContainmentTest::ANGLE_SUM},
+                                              std::pair{"ray_casting", ContainmentTest::RAY_CASTING},
+                                              std::pair{"edge_index", ContainmentTest::EDGE_INDEX}};
+
+    std::vector<bool> reference;
+    for(auto [name, test] : containment_tests) {
+        std::vector<bool> inside;
+        inside.reserve(tests.size());
 
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for(const auto& [lat, lng, p, polygon] : tests) {
+            inside.emplace_back(polygons[polygon].pointInPolygon(lat, lng, p, test));
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        auto time_diff_us = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+        const auto number_inside = std::count(std::cbegin(inside), std::cend(inside), true);
+        std::size_t differences = 0;
+        if(!reference.empty()) {
+            for(std::size_t i = 0; i < inside.size(); i++) {
+                differences += inside[i] != reference[i];
+            }
+        }
 
+        fmt::print("{}: {}us for {} tests, {} inside, {} differences\n",
+                   name, time_diff_us, tests.size(), number_inside, differences);
+        log += fmt::format("{},{},{},{}\n", name, time_diff_us, number_inside, differences);
+
+        if(reference.empty()) {
+            reference = std::move(inside);
+        }
+    }
+
+    std::ofstream myfile;
+    myfile.open(fmt::format("../results/containment_{}.csv", env.getNumberOfSphereNodes()));
+    myfile << log;
+    myfile.close();
+}
+
+// the polygons are simplified to a fraction of the distance between the nodes of
+// the grid. only nodes this close to the coast may be classified differently
+static auto simplificationTolerance(const SphericalGrid& grid) noexcept
+    -> double
+{
+    constexpr auto TOLERANCE_PER_SPACING = 0.25;
+    return grid.nodeSpacing() * TOLERANCE_PER_SPACING;
+}
+
+static auto simplifyForGrid(const Environment& env,
+                            const SphericalGrid& grid,
+                            std::vector<Polygon>&& polygons) noexcept
+    -> std::vector<Polygon>
+{
+    const auto tolerance = simplificationTolerance(grid);
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    auto simplified = simplifyPolygons(polygons, tolerance);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    auto time_diff_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+
+    const auto points_before = numberOfPoints(polygons);
+    const auto points_after = numberOfPoints(simplified);
+    fmt::print("simplified the polygons with a tolerance of {:.0f}m from {} to {} points ({:.1f}%) in {}ms\n",
+               tolerance,
+               points_before,
+               points_after,
+               100.0 * points_after / std::max(points_before, std::size_t{1}),
+               time_diff_ms);
+
+    if(env.filterBenchmark()) {
+        SphericalGrid original{env.getNumberOfSphereNodes()};
+        SphericalGrid simplified_grid{env.getNumberOfSphereNodes()};
+        original.filter(polygons, env.getFilterMode(), env.getContainmentTest());
+        simplified_grid.filter(simplified, env.getFilterMode(), env.getContainmentTest());
+
+        std::size_t changed = 0;
+        for(std::size_t i = 0; i < original.size(); i++) {
+            changed += original.indexIsWater(i) != simplified_grid.indexIsWater(i);
+        }
+        fmt::print("{} of {} nodes are classified differently after the simplification\n",
+                   changed,
+                   original.size());
+    }
+
+    return simplified;
+}
+
+static auto parsePolygons(const Environment& environment) noexcept
+    -> std::vector<Polygon>
+{
     std::cout << "Parsing pbf file..." << std::endl;
-    auto [nodes, coastlines] = parsePBFFile(environment.getDataFile());
+    auto [nodes, coastlines] = parsePBFFile(environment.getDataFile(),
+                                            environment.twoPassExtraction());
     std::cout << "calculating polygons..." << std::endl;
 
-    auto polygons = calculatePolygons(std::move(coastlines),
-                                      std::move(nodes));
+    return calculatePolygons(std::move(coastlines),
+                             std::move(nodes));
+}
+
+// loads the assembled polygons from the polygon cache if one is configured and matches
+// the data file, otherwise they are parsed from the data file and written to the cache
+static auto loadOrParsePolygons(const Environment& environment,
+                                std::optional<std::uint64_t> data_checksum) noexcept
+    -> std::vector<Polygon>
+{
+    const auto& cache_file = environment.getPolygonCacheFile();
+    if(!cache_file or !data_checksum) {
+        return parsePolygons(environment);
+    }
+
+    auto cached = loadPolygons(cache_file.value(), data_checksum.value());
+    if(cached) {
+        std::cout << "loaded polygons from " << cache_file.value() << std::endl;
+        return std::move(cached.value());
+    }
+
+    auto polygons = parsePolygons(environment);
+    if(savePolygons(cache_file.value(), data_checksum.value(), polygons)) {
+        std::cout << "wrote polygon cache to " << cache_file.value() << std::endl;
+    } else {
+        std::cout << "unable to write polygon cache to " << cache_file.value() << std::endl;
+    }
+
+    return polygons;
+}
+
+static auto buildGrid(const Environment& environment,
+                      std::optional<std::uint64_t> data_checksum) noexcept
+    -> SphericalGrid
+{
+    auto polygons = loadOrParsePolygons(environment, data_checksum);
 
     std::cout << "building the grid..." << std::endl;
     SphericalGrid grid{environment.getNumberOfSphereNodes()};
 
+    if(environment.polygonSimplification()) {
+        std::cout << "simplifying polygons..." << std::endl;
+        polygons = simplifyForGrid(environment, grid, std::move(polygons));
+    }
+
+    if(environment.filterBenchmark()) {
+        benchmarkFilter(environment, polygons);
+    }
+    if(environment.containmentBenchmark()) {
+        benchmarkContainment(environment, polygons);
+    }
+
     std::cout << "filtering land nodes ... " << std::endl;
     std::chrono::steady_clock::time_point begin_filter = std::chrono::steady_clock::now();
-    grid.filter(polygons);
+    grid.filter(polygons,
+                environment.getFilterMode(),
+                environment.getContainmentTest());
     std::chrono::steady_clock::time_point end_filter = std::chrono::steady_clock::now();
     std::cout << "Filtering took " << std::chrono::duration_cast<std::chrono::seconds>(end_filter - begin_filter).count() << "[s]" << std::endl;
 
-    Graph graph{std::move(grid)};
+    return grid;
+}
+
+// checksum of the data file, only calculated if a cache or snapshot is used
+static auto dataChecksum(const Environment& environment) noexcept
+    -> std::optional<std::uint64_t>
+{
+    if(!environment.getGridCacheFile()
+       and !environment.getPolygonCacheFile()
+       and !environment.getGraphSnapshotFile()) {
+        return std::nullopt;
+    }
+
+    std::cout << "calculating checksum of the data file..." << std::endl;
+    auto checksum = fileChecksum(environment.getDataFile());
+    if(!checksum) {
+        std::cout << "unable to read the data file, not using any cache" << std::endl;
+    }
+    return checksum;
+}
+
+// key of the grid cache and graph snapshot. grids filtered with simplified polygons,
+// another filter mode or another containment test differ from each other near the
+// coast and must not be mixed up, every option changes the key in its own way
+static auto gridChecksum(const Environment& environment,
+                         std::optional<std::uint64_t> data_checksum) noexcept
+    -> std::optional<std::uint64_t>
+{
+    constexpr auto SIMPLIFIED_POLYGONS_KEY = std::uint64_t{0x53494d504c494659ull};
+    constexpr auto FILTER_MODE_KEY = std::uint64_t{0x46494c5445524d44ull};
+    constexpr auto CONTAINMENT_TEST_KEY = std::uint64_t{0x434f4e5441494e53ull};
+    if(!data_checksum) {
+        return std::nullopt;
+    }
+
+    auto checksum = data_checksum.value();
+    if(environment.polygonSimplification()) {
+        checksum ^= SIMPLIFIED_POLYGONS_KEY;
+    }
+    checksum ^= FILTER_MODE_KEY * (static_cast<std::uint64_t>(environment.getFilterMode()) + 1);
+    checksum ^= CONTAINMENT_TEST_KEY * (static_cast<std::uint64_t>(environment.getContainmentTest()) + 1);
+    return checksum;
+}
+
+// loads the filtered grid from the grid cache if one is configured and matches
+// the data file, otherwise the grid is built from scratch and written to the cache
+static auto loadOrBuildGrid(const Environment& environment,
+                            std::optional<std::uint64_t> data_checksum) noexcept
+    -> SphericalGrid
+{
+    const auto& cache_file = environment.getGridCacheFile();
+    const auto grid_checksum = gridChecksum(environment, data_checksum);
+    if(!cache_file or !grid_checksum) {
+        return buildGrid(environment, data_checksum);
+    }
+
+    auto cached = SphericalGrid::load(cache_file.value(),
+                                      grid_checksum.value(),
+                                      environment.getNumberOfSphereNodes());
+    if(cached) {
+        std::cout << "loaded grid from " << cache_file.value() << std::endl;
+        return std::move(cached.value());
+    }
+
+    auto grid = buildGrid(environment, data_checksum);
+    if(grid.save(cache_file.value(),
+                 grid_checksum.value(),
+                 environment.getNumberOfSphereNodes())) {
+        std::cout << "wrote grid cache to " << cache_file.value() << std::endl;
+    } else {
+        std::cout << "unable to write grid cache to " << cache_file.value() << std::endl;
+    }
+
+    return grid;
+}
+
+// incremental update: updates the grid cache built from a previous version of the data
+// file, whose polygons are still in the polygon cache. only the nodes around the parts
+// of the rings which changed are classified again. the graph snapshot of the previous
+// grid is kept if no node changed, otherwise only the nodes around the changed ones
+// get new edges and the graph is contracted again in the order of the previous one
+static auto applyDataUpdate(const Environment& environment,
+                            std::optional<std::uint64_t> data_checksum) noexcept
+    -> void
+{
+    const auto& polygon_cache = environment.getPolygonCacheFile();
+    const auto& grid_cache = environment.getGridCacheFile();
+    if(!data_checksum or !polygon_cache or !grid_cache) {
+        std::cout << "incremental updates need a polygon and a grid cache" << std::endl;
+        return;
+    }
+
+    const auto previous_checksum = polygonFileChecksum(polygon_cache.value());
+    if(!previous_checksum or previous_checksum == data_checksum) {
+        return;
+    }
+
+    const auto number_of_nodes = environment.getNumberOfSphereNodes();
+    const auto previous_grid_checksum = gridChecksum(environment, previous_checksum);
+    auto previous_polygons = loadPolygons(polygon_cache.value(), previous_checksum.value());
+    auto grid = SphericalGrid::load(grid_cache.value(),
+                                    previous_grid_checksum.value(),
+                                    number_of_nodes);
+    if(!previous_polygons or !grid) {
+        std::cout << "no grid of the previous data file found, building from scratch" << std::endl;
+        return;
+    }
+
+    std::cout << "updating the grid of the previous data file..." << std::endl;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    auto polygons = loadOrParsePolygons(environment, data_checksum);
+    if(environment.polygonSimplification()) {
+        // the grid was filtered with the simplified rings, they are compared instead
+        previous_polygons = simplifyPolygons(previous_polygons.value(),
+                                             simplificationTolerance(grid.value()));
+        polygons = simplifyForGrid(environment, grid.value(), std::move(polygons));
+    }
+
+    const auto boxes = changedBoundingBoxes(previous_polygons.value(), polygons);
+    previous_polygons.reset();
+
+    const auto changed_nodes = grid->refilter(polygons,
+                                               boxes,
+                                               environment.getFilterMode(),
+                                               environment.getContainmentTest());
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    fmt::print("{} bounding boxes of changed edges, {} nodes changed between land and water in {}ms\n",
+               boxes.size(),
+               changed_nodes,
+               std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+
+    const auto grid_checksum = gridChecksum(environment, data_checksum);
+    if(!grid->save(grid_cache.value(), grid_checksum.value(), number_of_nodes)) {
+        std::cout << "unable to write grid cache to " << grid_cache.value() << std::endl;
+        return;
+    }
+    std::cout << "wrote updated grid cache to " << grid_cache.value() << std::endl;
+
+    const auto& snapshot_file = environment.getGraphSnapshotFile();
+    if(!snapshot_file) {
+        return;
+    }
+
+    auto previous_graph = Graph::loadSnapshot(snapshot_file.value(),
+                                              previous_grid_checksum.value(),
+                                              number_of_nodes,
+                                              environment.getContractionOrder(),
+                                              environment.getWitnessSearchLimits(),
+                                              false);
+    if(!previous_graph) {
+        std::cout << "no graph snapshot of the previous data file found, contracting from scratch" << std::endl;
+        return;
+    }
+
+    // the contracted graph only depends on the grid, it stays valid if no node changed
+    if(changed_nodes == 0) {
+        if(previous_graph->saveSnapshot(snapshot_file.value(), grid_checksum.value(), number_of_nodes)) {
+            std::cout << "kept the graph snapshot for the updated data file" << std::endl;
+        }
+        return;
+    }
+
+    begin = std::chrono::steady_clock::now();
+    Graph graph{std::move(grid.value()), previous_graph.value()};
+    graph.contractInOrderOf(previous_graph.value());
+    end = std::chrono::steady_clock::now();
+    fmt::print("updated the graph in {}s\n",
+               std::chrono::duration_cast<std::chrono::seconds>(end - begin).count());
+
+    if(graph.saveSnapshot(snapshot_file.value(), grid_checksum.value(), number_of_nodes)) {
+        std::cout << "wrote updated graph snapshot to " << snapshot_file.value() << std::endl;
+    } else {
+        std::cout << "unable to write graph snapshot to " << snapshot_file.value() << std::endl;
+    }
+}
+
+static auto loadGraphSnapshot(const Environment& environment,
+                              std::optional<std::uint64_t> data_checksum) noexcept
+    -> std::optional<Graph>
+{
+    const auto& snapshot_file = environment.getGraphSnapshotFile();
+    if(!snapshot_file or !data_checksum) {
+        return std::nullopt;
+    }
+
+    auto graph = Graph::loadSnapshot(snapshot_file.value(),
+                                     data_checksum.value(),
+                                     environment.getNumberOfSphereNodes(),
+                                     environment.getContractionOrder(),
+                                     environment.getWitnessSearchLimits(),
+                                     environment.prefetchSnapshot());
+    if(graph) {
+        std::cout << "loaded contracted graph from " << snapshot_file.value() << std::endl;
+    }
+
+    return graph;
+}
+
+static auto saveGraphSnapshot(const Environment& environment,
+                              std::optional<std::uint64_t> data_checksum,
+                              const Graph& graph) noexcept
+    -> void
+{
+    const auto& snapshot_file = environment.getGraphSnapshotFile();
+    if(!snapshot_file or !data_checksum) {
+        return;
+    }
+
+    if(graph.saveSnapshot(snapshot_file.value(),
+                          data_checksum.value(),
+                          environment.getNumberOfSphereNodes())) {
+        std::cout << "wrote graph snapshot to " << snapshot_file.value() << std::endl;
+    } else {
+        std::cout << "unable to write graph snapshot to " << snapshot_file.value() << std::endl;
+    }
+}
+
+
+auto main() -> int
+{
+    auto environment = [] {
+        auto environment_opt = loadEnv();
+        if(!environment_opt) {
+            std::cout << "the environment variables could not be understood" << std::endl;
+            std::cout << "using default values" << std::endl;
+
+            auto environment = Environment{9090,
+                                           //    "../data/antarctica-latest.osm.pbf",
+                                           "../data/planet-coastlines.pbf",
+                                           100};
+            loadOptionalEnv(environment);
+            return environment;
+        }
+
+        return environment_opt.value();
+    }();
+
+
+    // NON_EXISTENT is reserved, every other id has to fit into NodeId
+    if(environment.getNumberOfSphereNodes() >= NON_EXISTENT) {
+        fmt::print("the ids of {} nodes do not fit into {} bits, build with SHIPROUTER_INDEX_BITS=64\n",
+                   environment.getNumberOfSphereNodes(),
+                   SHIPROUTER_INDEX_BITS);
+        return 1;
+    }
+
+    const auto data_checksum = dataChecksum(environment);
+    const auto grid_checksum = gridChecksum(environment, data_checksum);
+
+    if(environment.incrementalUpdate()) {
+        applyDataUpdate(environment, data_checksum);
+    }
+
+    // plain dijkstra without materializing the edges, for grids whose graph does not fit into memory
+    if(environment.implicitGraph()) {
+        const ImplicitGridGraph graph{loadOrBuildGrid(environment, data_checksum)};
+        const auto st_pairs = graph.randomSTPairs(100);
+        ImplicitDijkstra dijkstra{graph};
+        benchmark("implicit", environment, st_pairs, [&](NodeId s, NodeId t) {
+            return dijkstra.findRoute(s, t);
+        });
+        return 0;
+    }
+
+    auto graph_opt = loadGraphSnapshot(environment, grid_checksum);
+    const auto loaded_snapshot = graph_opt.has_value();
+    if(!loaded_snapshot) {
+        graph_opt.emplace(loadOrBuildGrid(environment, data_checksum));
+    }
+    auto& graph = graph_opt.value();
 
     // get n random source-target tuples
     std::vector<std::pair<NodeId, NodeId>> st_pairs = graph.randomSTPairs(100);
-    // run normal dijkstra on these tuples and save to file
-    Dijkstra dijkstra{graph};
-    benchmark("normal", environment, st_pairs, [&](NodeId s, NodeId t) {
-        return dijkstra.findRoute(s, t);
-    });
-    std::chrono::steady_clock::time_point begin_contract = std::chrono::steady_clock::now();
-    graph.contract(); // contract graph
-    std::chrono::steady_clock::time_point end_contract = std::chrono::steady_clock::now();
-    std::cout << "Contracting took " << std::chrono::duration_cast<std::chrono::seconds>(end_contract - begin_contract).count() << "[s]" << std::endl;
+
+    if(!loaded_snapshot) {
+        // run normal dijkstra on these tuples and save to file
+        Dijkstra dijkstra{graph};
+        benchmark("normal", environment, st_pairs, [&](NodeId s, NodeId t) {
+            return dijkstra.findRoute(s, t);
+        });
+        std::chrono::steady_clock::time_point begin_contract = std::chrono::steady_clock::now();
+        graph.contract(environment.getContractionOrder(),
+                       environment.getWitnessSearchLimits()); // contract graph
+        std::chrono::steady_clock::time_point end_contract = std::chrono::steady_clock::now();
+        std::cout << "Contracting took " << std::chrono::duration_cast<std::chrono::seconds>(end_contract - begin_contract).count() << "[s]" << std::endl;
+
+        saveGraphSnapshot(environment, grid_checksum, graph);
+    }
+
+    if(environment.preprocessOnly()) {
+        std::cout << "preprocessing done" << std::endl;
+        return 0;
+    }
+
     // run ch-dijkstra on same tuples and save to different file
     CHDijkstra ch_dijkstra{graph};
     benchmark("ch", environment, st_pairs, [&](NodeId s, NodeId t) {